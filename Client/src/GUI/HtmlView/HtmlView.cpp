@@ -482,6 +482,11 @@ void HtmlView::on_packet_receive(std::unique_ptr<class Packet> packet)
     m_current_page->on_packet_receive(std::move(packet));
 }
 
+void HtmlView::on_session_resumed()
+{
+    m_current_page->on_session_resumed();
+}
+
 template <typename TRet>
 std::shared_ptr<TRet> HtmlView::get_page() const
 {
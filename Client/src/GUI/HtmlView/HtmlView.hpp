@@ -42,6 +42,7 @@ public:
     void on_lButton_up(int x, int y) const;
     void on_mouse_leave() const;
     void on_packet_receive(std::unique_ptr<class Packet> packet);
+    void on_session_resumed();
     void media_changed() const;
     void draw(litehtml::uint_ptr hdc, const litehtml::position* clip) const;
 
@@ -1,12 +1,13 @@
 #include "BookingsPage.hpp"
 #include "../../HtmlView/HtmlView.hpp"
 #include "../../../Network/PacketManager/PacketManager.hpp"
+#include "../../../Network/Core/ResultSet.hpp"
 #include "../../Elements/el_input.hpp"
+#include "../../../Utils/Validators.hpp"
 
 #include <litehtml/el_tr.h>
 #include <litehtml/el_td.h>
 #include <unordered_set>
-#include <regex>
 #include <print>
 
 template<typename T>
@@ -18,6 +19,42 @@ static T safe_cast(const std::string& str) {
     return (result.ec == std::errc() && result.ptr == str.data() + str.size()) ? value : T{};
 }
 
+static std::string json_to_string(const nlohmann::json& val) {
+    if (val.is_null()) return "";
+
+    if (val.is_string()) {
+        return val.get<std::string>();
+    }
+    else if (val.is_number_integer()) {
+        return std::to_string(val.get<int64_t>());
+    }
+    else if (val.is_number_unsigned()) {
+        return std::to_string(val.get<uint64_t>());
+    }
+    else if (val.is_number_float()) {
+        return std::to_string(val.get<double>());
+    }
+    else if (val.is_boolean()) {
+        return val.get<bool>() ? "true" : "false";
+    }
+
+    return val.dump();
+}
+
+// Fields of a GetData row or a RowChangePacket row, in table column order
+template<typename Row>
+static std::vector<std::pair<std::string, std::string>> make_booking(Row const& row) {
+    const static std::vector<std::string> keys = {
+        "id", "user_id", "room_id", "check_in_date", "check_out_date", "booking_date", "status"
+    };
+
+    std::vector<std::pair<std::string, std::string>> booking;
+    for (const auto& key : keys) {
+        booking.push_back(std::make_pair(key, row.contains(key) ? json_to_string(row[key]) : ""));
+    }
+    return booking;
+}
+
 bool BookingsPage::init()
 {
     auto view = m_view.lock();
@@ -62,7 +99,9 @@ void BookingsPage::delete_data(litehtml::element::ptr const& el)
             return;
         }
 
-        view->switch_page(PageID::BOOKINGS);
+        // The row is already gone, the server pushed the change ahead of this response
+        this->show_bookings();
+        view->render();
     });
 }
 
@@ -142,13 +181,10 @@ void BookingsPage::edit_data_action()
     std::string checkout_value = checkout->get_value();
     std::string status_value = status->get_value();
 
-    std::regex id_regex(R"(^\d+$)");
-    std::regex date_regex(R"-(^\d{4}-(0[1-9]|1[0-2])-(0[1-9]|[12]\d|3[01])$)-");
-
-    bool is_user_valid = std::regex_match(user_value, id_regex);
-    bool is_room_valid = std::regex_match(room_value, id_regex);
-    bool is_checkin_valid = std::regex_match(checkin_value, date_regex);
-    bool is_checkout_valid = std::regex_match(checkout_value, date_regex);
+    bool is_user_valid = Validators::isId(user_value);
+    bool is_room_valid = Validators::isId(room_value);
+    bool is_checkin_valid = Validators::isDate(checkin_value);
+    bool is_checkout_valid = Validators::isDate(checkout_value);
     bool error = !is_user_valid || !is_room_valid || !is_checkin_valid || !is_checkout_valid;
 
     auto edit_user_err = m_doc->root()->select_one("#edit-user-err");
@@ -197,7 +233,9 @@ void BookingsPage::edit_data_action()
             return;
         }
 
-        view->switch_page(PageID::BOOKINGS);
+        this->show_bookings();
+        view->reset_scroll();
+        view->render();
     });
 }
 
@@ -242,13 +280,10 @@ void BookingsPage::register_booking_action()
     std::string checkout_value = checkout->get_value();
     std::string status_value = status->get_value();
 
-    std::regex id_regex(R"(^\d+$)");
-    std::regex date_regex(R"-(^\d{4}-(0[1-9]|1[0-2])-(0[1-9]|[12]\d|3[01])$)-");
-
-    bool is_user_valid = std::regex_match(user_value, id_regex);
-    bool is_room_valid = std::regex_match(room_value, id_regex);
-    bool is_checkin_valid = std::regex_match(checkin_value, date_regex);
-    bool is_checkout_valid = std::regex_match(checkout_value, date_regex);
+    bool is_user_valid = Validators::isId(user_value);
+    bool is_room_valid = Validators::isId(room_value);
+    bool is_checkin_valid = Validators::isDate(checkin_value);
+    bool is_checkout_valid = Validators::isDate(checkout_value);
     bool error = !is_user_valid || !is_room_valid || !is_checkin_valid || !is_checkout_valid;
 
     auto edit_user_err = m_doc->root()->select_one("#reg-user-err");
@@ -290,7 +325,9 @@ void BookingsPage::register_booking_action()
         auto response = dynamic_cast<ResponsePacket*>(packet.get());
 
         if (response->errorCode == ResponseID::Sucess) {
-            view->switch_page(PageID::BOOKINGS);
+            this->show_bookings();
+            view->reset_scroll();
+            view->render();
         }
         else {
             auto reg_err = m_doc->root()->select_one("#reg-err");
@@ -307,19 +344,9 @@ void BookingsPage::register_booking_action()
 
 void BookingsPage::sort_data(std::string&& field_name)
 {
-    auto get_field = [](const booking_data_t& data, const std::string& key) -> std::string {
-        for (const auto& pair : data) {
-            if (pair.first == key)
-                return pair.second;
-        }
-        return "";
-        };
-
     auto view = m_view.lock();
     if (!view) return;
 
-    auto sorted_bookings = sorted_bookings_t(m_bookings.begin(), m_bookings.end());
-
     auto input_sort = std::dynamic_pointer_cast<el_input>(m_doc->root()->select_one("#input-sort"));
     auto& sort_value = input_sort->get_value();
 
@@ -331,105 +358,128 @@ void BookingsPage::sort_data(std::string&& field_name)
         }
     }
     m_last_sort_value = sort_value;
+    m_current_sort = std::make_pair(std::move(field_name), sort_type);
 
-    std::sort(sorted_bookings.begin(), sorted_bookings.end(), [&](const auto& u1, const auto& u2) {
-        auto compare = [&]<typename T>(T const& arg1, T const& arg2) -> bool {
-            if (sort_type == SortType::ASCENDING) return arg1 < arg2;
-            else return arg1 > arg2;
-        };
-
-        if (const static std::unordered_set<std::string> fields_to_check = { "id", "user_id", "room_id" }; fields_to_check.contains(field_name)) {
-            auto num1 = safe_cast<int>(get_field(u1.second, field_name));
-            auto num2 = safe_cast<int>(get_field(u2.second, field_name));
-            return compare(num1, num2);
-        }
-
-        if (field_name == "id") {
-            auto id1 = safe_cast<int>(get_field(u1.second, field_name));
-            auto id2 = safe_cast<int>(get_field(u2.second, field_name));
-            return compare(id1, id2);
-        }
+    // Sorting and filtering run on the server, only the first page comes back
+    this->load_bookings(false);
+}
 
-        std::string a = get_field(u1.second, field_name);
-        std::string b = get_field(u2.second, field_name);
-        std::string lowerA, lowerB;
-        std::transform(a.begin(), a.end(), std::back_inserter(lowerA), ::tolower);
-        std::transform(b.begin(), b.end(), std::back_inserter(lowerB), ::tolower);
-        return compare(lowerA, lowerB);
-        });
+void BookingsPage::load_bookings(bool next_page, bool resumed)
+{
+    auto const& [field_name, sort_type] = m_current_sort;
 
+    GetDataPacket gdp(TableID::BOOKINGS);
+    gdp.setPage(page_size).setOrder(field_name, sort_type == SortType::DESCENDING);
 
-    if (sort_value != "") {
-        sorted_bookings.erase(
-            std::remove_if(
-                sorted_bookings.begin(),
-                sorted_bookings.end(),
-                [&](const auto& booking) {
-                    const auto& fields = booking.second;
-                    return std::none_of(fields.begin(), fields.end(), [&](const auto& field) {
-                        if (field.first != field_name) return false;
-
-                        if (const static std::unordered_set<std::string> fields_to_check = { "check_in_date", "check_out_date", "booking_date" }; fields_to_check.contains(field_name)) {
-                            return field.second >= sort_value;
-                        }
-
-                        if (field_name == "id") {
-                            auto sort_id = safe_cast<int>(sort_value);
-                            auto id = safe_cast<int>(field.second);
-                            return id == sort_id;
-                        }
-
-                        return field.second.find(sort_value) != std::string::npos;
-                        });
-                }
-            ),
-            sorted_bookings.end()
-        );
+    if (!m_last_sort_value.empty() && !field_name.empty()) {
+        if (const static std::unordered_set<std::string> date_fields = { "check_in_date", "check_out_date", "booking_date" }; date_fields.contains(field_name)) {
+            gdp.addFilter(field_name, FilterOp::ge, m_last_sort_value);
+        }
+        else if (const static std::unordered_set<std::string> id_fields = { "id", "user_id", "room_id" }; id_fields.contains(field_name)) {
+            gdp.addFilter(field_name, FilterOp::eq, safe_cast<long long>(m_last_sort_value));
+        }
+        else {
+            gdp.addFilter(field_name, FilterOp::contains, m_last_sort_value);
+        }
     }
 
-    m_current_sort = std::make_pair(std::move(field_name), sort_type);
+    if (next_page) gdp.setCursor(m_cursor_id, m_cursor_value);
+
+    m_load_request = gdp.getRequestID();
+    this->begin_load();
+    this->send_packet_async(gdp, [this, next_page, resumed, request = m_load_request](std::unique_ptr<Packet> packet) {
+        if (packet->getID() != PacketID::Response || request != m_load_request) return;
 
-    this->push_draw_task([sort_value = std::move(sort_value), sorted_bookings = std::move(sorted_bookings), this]() {
         auto view = m_view.lock();
         if (!view) return;
 
-        std::string html;
+        auto* response = dynamic_cast<ResponsePacket*>(packet.get());
 
-        for (const auto& booking : sorted_bookings) {
-            html += "<tr>";
+        if (!next_page) {
+            m_bookings.clear();
+            m_bookings_order.clear();
+            m_has_more = false;
+        }
 
-            for (auto const& field : booking.second) {
-                if (const static std::unordered_set<std::string> testedStr = { "user_id", "room_id" }; testedStr.contains(field.first)) {
-                    html += std::format(R"(<td class="link" id="switch-{}" data-record-id="{}">{}</td>)", field.first, field.second, field.second);
-                }
-                else {
-                    html += std::format(R"(<td>{}</td>)", field.second);
-                }
-            }
+        if (response->errorCode == ResponseID::Sucess) {
+            auto const& order_key = m_current_sort.first.empty() ? std::string("id") : m_current_sort.first;
 
-            html += std::format(
-                R"(<td class="link" id="edit-record-button" data-record-id="{}">Изменить</td><td class="link" id="delete-record-button" data-record-id="{}">Удалить</td>)",
-                booking.first,
-                booking.first
-            );
+            ResultSet rows(response->additionalData);
+            for (const auto& row : rows) {
+                auto booking = make_booking(row);
 
-            html += "</tr>";
+                // The last row is where the next page starts
+                m_cursor_id = row["id"].get<int64_t>();
+                m_cursor_value = row[order_key];
+
+                m_bookings_order.push_back(booking[0].second);
+                m_bookings.insert_or_assign(booking[0].second, std::move(booking));
+            }
+            m_has_more = rows.hasMore();
         }
 
-        html = HtmlView::replace_placeholder(m_html, "{{ROWS}}", html);
-        m_doc = litehtml::document::createFromString(html, view.get());
+        this->end_load(response->sequence);
 
-        view->reset_scroll();
+        // An open form is left alone, the table shows the rows once it is back
+        if (resumed && !m_doc->root()->select_one("#input-sort")) return;
+
+        this->show_bookings();
+
+        if (response->errorCode != ResponseID::Sucess) {
+            auto deletion_err = m_doc->root()->select_one("#deletion-err");
+            for (auto& child : deletion_err->children()) {
+                auto el_text = std::dynamic_pointer_cast<el_textholder>(child);
+                if (!el_text) continue;
 
-        if (auto deletion_err = m_doc->root()->select_one("#deletion-err")) {
-            auto reg_err_text = std::make_shared<el_textholder>("", m_doc);
-            reg_err_text->appendTo(deletion_err);
+                el_text->set_text(std::format("Ошибка {}: {}", static_cast<int>(response->errorCode), response->errorMessage));
+            }
         }
 
-        auto input_sort = std::dynamic_pointer_cast<el_input>(m_doc->root()->select_one("#input-sort"));
-        input_sort->value(sort_value, true);
+        if (!next_page) view->reset_scroll();
         view->render();
-        });
+    });
+}
+
+void BookingsPage::show_bookings()
+{
+    auto view = m_view.lock();
+    if (!view) return;
+
+    std::string html;
+
+    for (const auto& id : m_bookings_order) {
+        html += "<tr>";
+
+        for (auto const& field : m_bookings.at(id)) {
+            if (const static std::unordered_set<std::string> testedStr = { "user_id", "room_id" }; testedStr.contains(field.first)) {
+                html += std::format(R"(<td class="link" id="switch-{}" data-record-id="{}">{}</td>)", field.first, field.second, field.second);
+            }
+            else {
+                html += std::format(R"(<td>{}</td>)", field.second);
+            }
+        }
+
+        html += std::format(
+            R"(<td class="link" id="edit-record-button" data-record-id="{}">Изменить</td><td class="link" id="delete-record-button" data-record-id="{}">Удалить</td>)",
+            id,
+            id
+        );
+
+        html += "</tr>";
+    }
+
+    html = HtmlView::replace_placeholder(m_html, "{{ROWS}}", html);
+    html = HtmlView::replace_placeholder(html, "{{MORE}}", m_has_more ? R"(<p class="link" id="load-more-button">Показать ещё</p>)" : "");
+    m_doc = litehtml::document::createFromString(html, view.get());
+
+    if (auto deletion_err = m_doc->root()->select_one("#deletion-err")) {
+        auto reg_err_text = std::make_shared<el_textholder>("", m_doc);
+        reg_err_text->appendTo(deletion_err);
+    }
+
+    if (auto input_sort = std::dynamic_pointer_cast<el_input>(m_doc->root()->select_one("#input-sort"))) {
+        input_sort->value(m_last_sort_value, true);
+    }
 }
 
 bool BookingsPage::on_element_click(const litehtml::element::ptr& el)
@@ -462,7 +512,10 @@ bool BookingsPage::on_element_click(const litehtml::element::ptr& el)
             auto view = m_view.lock();
             if (!view) return;
 
-            view->switch_page(PageID::BOOKINGS);
+            // The loaded rows are kept current by the change feed, no need to fetch them again
+            this->show_bookings();
+            view->reset_scroll();
+            view->render();
             });
         return true;
     }
@@ -509,6 +562,10 @@ bool BookingsPage::on_element_click(const litehtml::element::ptr& el)
             });
         return true;
     }
+    else if (!strcmp(id, "load-more-button")) {
+        this->load_bookings(true);
+        return true;
+    }
     else if (std::string field = id, prefix = "sort-"; field.find(prefix) == 0) {
         field = field.substr(prefix.length());
         this->sort_data(std::move(field));
@@ -517,87 +574,84 @@ bool BookingsPage::on_element_click(const litehtml::element::ptr& el)
    
 }
 
-void BookingsPage::on_switch(nlohmann::json data) {
-    GetDataPacket gdp(TableID::BOOKINGS);
-
-    auto safe_get = [](const nlohmann::json& obj, const std::string& key) -> std::string {
-        if (!obj.contains(key) || obj[key].is_null()) return "";
-
-        const auto& val = obj[key];
-
-        if (val.is_string()) {
-            return val.get<std::string>();
-        }
-        else if (val.is_number_integer()) {
-            return std::to_string(val.get<int64_t>());
-        }
-        else if (val.is_number_unsigned()) {
-            return std::to_string(val.get<uint64_t>());
-        }
-        else if (val.is_number_float()) {
-            return std::to_string(val.get<double>());
-        }
-        else if (val.is_boolean()) {
-            return val.get<bool>() ? "true" : "false";
-        }
+void BookingsPage::on_row_change(RowChangePacket const& change)
+{
+    if (change.table != TableID::BOOKINGS) return;
 
-        return val.dump();
+    auto id = std::to_string(change.rowID);
+    if (change.change == RowChange::Deleted) {
+        m_bookings.erase(id);
+        std::erase(m_bookings_order, id);
+    }
+    else if (m_bookings.contains(id)) {
+        m_bookings.insert_or_assign(id, make_booking(change.row));
+    }
+    else if (change.change == RowChange::Added && m_last_sort_value.empty()) {
+        // Placed the way the server orders, by the sort column and then by id.
+        // A filtered list or a row past the loaded pages is left to the next fetch
+        auto const& [field_name, sort_type] = m_current_sort;
+        const static std::unordered_set<std::string> id_fields = { "id", "user_id", "room_id" };
+
+        auto booking = make_booking(change.row);
+        auto field = [&field_name](booking_data_t const& data) -> std::string {
+            for (auto const& pair : data)
+                if (pair.first == field_name) return pair.second;
+            return "";
         };
-
-    this->send_packet(gdp, [this, safe_get = safe_get, data = std::move(data)](std::unique_ptr<Packet> packet) {
-        if (packet->getID() != PacketID::Response) return;
-
-        auto view = m_view.lock();
-        if (!view) return;
-
-        auto* response = dynamic_cast<ResponsePacket*>(packet.get());
-        auto& data = response->additionalData;
-
-        std::vector<std::string> keys = {
-            "id", "user_id", "room_id", "check_in_date", "check_out_date", "booking_date", "status"
+        auto goes_before = [&](booking_data_t const& other) {
+            auto a = field(booking), b = field(other);
+            bool less;
+            if (a != b)
+                less = id_fields.contains(field_name) ? safe_cast<long long>(a) < safe_cast<long long>(b) : a < b;
+            else
+                less = safe_cast<long long>(booking[0].second) < safe_cast<long long>(other[0].second);
+            return sort_type == SortType::ASCENDING ? less : !less;
         };
 
-        std::string html;
+        auto it = std::find_if(m_bookings_order.begin(), m_bookings_order.end(), [&](std::string const& other) {
+            return goes_before(m_bookings.at(other));
+        });
+        if (it == m_bookings_order.end() && m_has_more) return;
 
-        for (const auto& booking : data) {
-            html += "<tr>";
+        m_bookings_order.insert(it, id);
+        m_bookings.insert_or_assign(id, std::move(booking));
+    }
+    else {
+        return;
+    }
 
-            std::vector<std::string> fields;
-            for (const auto& key : keys) {
-                auto field = safe_get(booking, key);
-                fields.emplace_back(std::move(field));
-            }
+    // An open form is left alone, the table picks the change up once it is shown again
+    auto input_sort = m_doc ? std::dynamic_pointer_cast<el_input>(m_doc->root()->select_one("#input-sort")) : nullptr;
+    if (!input_sort) return;
 
-            std::vector<std::pair<std::string, std::string>> booking;
-            for (size_t i = 0; i < fields.size(); ++i) {
-                booking.push_back(std::make_pair(keys[i], fields[i]));
-                if (const static std::unordered_set<std::string> testedStr = { "user_id", "room_id" }; testedStr.contains(keys[i])) {
-                    html += std::format(R"(<td class="link" id="switch-{}" data-record-id="{}">{}</td>)", keys[i], fields[i], fields[i]);
-                }
-                else {
-                    html += std::format(R"(<td>{}</td>)", fields[i]);
-                }
-            }
-            m_bookings.insert({ fields[0], std::move(booking) });
+    auto view = m_view.lock();
+    if (!view) return;
 
-            html += std::format(
-                R"(<td class="link" id="edit-record-button" data-record-id="{}">Изменить</td><td class="link" id="delete-record-button" data-record-id="{}">Удалить</td>)",
-                fields[0],
-                fields[0]
-            );
+    // Keep whatever is typed into the filter but not applied yet
+    auto typed = input_sort->get_value();
+    this->show_bookings();
+    if (auto new_input = std::dynamic_pointer_cast<el_input>(m_doc->root()->select_one("#input-sort"))) {
+        new_input->value(typed, true);
+    }
+    view->render();
+}
 
-            html += "</tr>";
-        }
+void BookingsPage::on_session_resumed() {
+    // Changes made while the connection was down never came, start over from the first page
+    this->push_draw_task([this]() {
+        this->subscribe(TableID::BOOKINGS);
+        this->load_bookings(false, true);
+    });
+}
 
-        html = HtmlView::replace_placeholder(m_html, "{{ROWS}}", html);
-        m_doc = litehtml::document::createFromString(html, view.get());
+void BookingsPage::on_switch(nlohmann::json data) {
+    // Changes committed while the fetch runs are put in order by their sequence, see Page::end_load
+    this->subscribe(TableID::BOOKINGS);
 
-        if (auto deletion_err = m_doc->root()->select_one("#deletion-err")) {
-            auto reg_err_text = std::make_shared<el_textholder>("", m_doc);
-            reg_err_text->appendTo(deletion_err);
-        }
+    m_current_sort = std::make_pair(std::string("id"), SortType::ASCENDING);
+    m_last_sort_value.clear();
 
-    });
+    this->load_bookings(false);
 }
 
 BookingsPage::BookingsPage(std::shared_ptr<HtmlView> view) : Page(view) {
@@ -733,6 +787,7 @@ BookingsPage::BookingsPage(std::shared_ptr<HtmlView> view) : Page(view) {
                         {{ROWS}}
                     </tbody>
                 </table>
+                {{MORE}}
                 <div>
                     <p style="color:red; font-size: 14px;" id="deletion-err"></p> 
                     <button id="add-booking-button">Добавить бронирование</button>
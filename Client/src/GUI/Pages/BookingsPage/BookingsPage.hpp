@@ -9,17 +9,26 @@ class BookingsPage : public Page {
 	};
 
 	using booking_data_t = std::vector<std::pair<std::string, std::string>>;  //std::vector<std::pair<key, value>>
-	using sorted_bookings_t = std::vector<std::pair<std::string, booking_data_t>>;
 	using bookings_list_t = std::unordered_map<std::string, booking_data_t>;
+	using bookings_order_t = std::vector<std::string>;  //ids in the order the server sent them
 	using current_sort_t = std::pair<std::string, SortType>;
 
+	// Rows per GetData request, further pages are fetched on demand
+	static constexpr uint32_t page_size = 50;
+
 private:
 	bookings_list_t		m_bookings;
+	bookings_order_t	m_bookings_order;
 	booking_data_t		m_booking_to_edit;
 	current_sort_t		m_current_sort;
 	std::string			m_edit_booking_html;
 	std::string			m_add_booking_html;
 	std::string			m_last_sort_value;
+	int64_t				m_cursor_id = 0;
+	nlohmann::json		m_cursor_value;
+	bool				m_has_more = false;
+	// Loads may be answered out of order, only the latest one is shown
+	uint64_t			m_load_request = 0;
 public:
 	BookingsPage(std::shared_ptr<HtmlView> view);
 	~BookingsPage() = default;
@@ -27,6 +36,8 @@ public:
 	bool init() override;
 	bool on_element_click(const litehtml::element::ptr& el) override;
 	void on_switch(nlohmann::json = nlohmann::json::object()) override;
+	void on_row_change(class RowChangePacket const& change) override;
+	void on_session_resumed() override;
 
 private:
 	void delete_data(litehtml::element::ptr const& elem);
@@ -35,4 +46,6 @@ private:
 	void register_booking();
 	void register_booking_action();
 	void sort_data(std::string&& field);
+	void load_bookings(bool next_page, bool resumed = false);
+	void show_bookings();
 };
\ No newline at end of file
@@ -2,10 +2,11 @@
 #include "../../HtmlView/HtmlView.hpp"
 #include "../../Elements/el_input.hpp"
 #include "../../../Network/PacketManager/PacketManager.hpp"
+#include "../../../Network/Client/Client.hpp"
+#include "../../../Utils/Validators.hpp"
 
 #include <litehtml/el_para.h>
 #include <litehtml/render_item.h>
-#include <regex>
 #include <print>
 
 template<typename T>
@@ -88,10 +89,7 @@ void LoginPage::login_user()
     std::string email_value = log_email->get_value();
     std::string password_value = log_password->get_value();
 
-    std::regex email_regex(R"(^[A-Za-z0-9._%+-]+@[A-Za-z0-9.-]+\.[A-Za-z]{2,}$)");
-    std::regex password_regex(R"(^.{8,}$)");
-
-    bool is_email_valid = std::regex_match(email_value, email_regex);
+    bool is_email_valid = Validators::isEmail(email_value);
     bool error = !is_email_valid;
 
     auto email_err = m_doc->root()->select_one("#log-email-err");
@@ -134,6 +132,9 @@ void LoginPage::login_user()
             el_text->set_text("");
         }
 
+        // Lets the connection log back in by itself after a drop
+        view->get_connection()->setSessionToken(response->additionalData.value("session_token", std::string()));
+
         view->switch_page(PageID::PROFILE, std::move(response->additionalData));
     });
 }
@@ -152,16 +153,11 @@ void LoginPage::register_user()
     std::string surname_value = surname->get_value();
     std::string phone_value = phone->get_value();
 
-    std::regex email_regex(R"(^[A-Za-z0-9._%+-]+@[A-Za-z0-9.-]+\.[A-Za-z]{2,}$)");
-    std::regex phone_regex(R"(^$|^\+?\d{10,15}$)");
-    std::regex name_regex(R"(^[A-Za-zА-Яа-яЁё]{1,20}$)");
-    std::regex password_regex(R"(^.{8,}$)");
-
-    bool is_email_valid = std::regex_match(email_value, email_regex);
-    bool is_phone_valid = std::regex_match(phone_value, phone_regex);
-    bool is_password_valid = std::regex_match(password_value, password_regex);
-    bool is_name_valid = std::regex_match(name_value, name_regex);
-    bool is_surname_valid = std::regex_match(surname_value, name_regex);
+    bool is_email_valid = Validators::isEmail(email_value);
+    bool is_phone_valid = Validators::isPhone(phone_value);
+    bool is_password_valid = Validators::isPassword(password_value);
+    bool is_name_valid = Validators::isName(name_value);
+    bool is_surname_valid = Validators::isName(surname_value);
     bool error = !is_email_valid || !is_phone_valid || !is_password_valid || !is_name_valid || !is_surname_valid;
 
     auto email_err = m_doc->root()->select_one("#email-err");
@@ -92,11 +92,16 @@ void Page::media_changed() const {
 }
 
 void Page::draw(litehtml::uint_ptr hdc, int x, int y, const litehtml::position* clip) {
-	while (!m_func_queue.empty()) {
-		auto& fn = m_func_queue.front();
+	functions_queue tasks;
+	{
+		std::lock_guard lock(m_func_mtx);
+		std::swap(tasks, m_func_queue);
+	}
+	while (!tasks.empty()) {
+		auto& fn = tasks.front();
 		fn();
 
-		m_func_queue.pop();
+		tasks.pop();
 	}
 	m_doc->draw(hdc, y, x, clip);
 }
@@ -112,15 +117,33 @@ void Page::get_doc_size(litehtml::size& size) const
 }
 
 void Page::on_packet_receive(std::unique_ptr<class Packet> packet) {
-	for (auto it = m_requests.begin(); it < m_requests.end();) {
-		if (it->first != packet->getRequestID()) {
-			it++;
-			continue;
-		}
-		it->second(std::move(packet));
-		it = m_requests.erase(it);
-		break;
+	// Pushed by the server, no request waits for it
+	if (packet->getID() == PacketID::RowChange) {
+		auto buf = std::make_shared<std::unique_ptr<Packet>>(std::move(packet));
+		this->push_draw_task([buf, this]() {
+			std::unique_ptr<RowChangePacket> change(static_cast<RowChangePacket*>(buf->release()));
+			if (change->table == m_feed_table) {
+				// Already part of the snapshot the page shows
+				if (!m_feed_loading && change->sequence <= m_feed_sequence) return;
+
+				this->on_row_change(*change);
+				if (m_feed_loading) m_feed_pending.push_back(std::move(change));
+				return;
+			}
+			this->on_row_change(*change);
+		});
+		return;
 	}
+
+	std::function<void(std::unique_ptr<Packet>)> callback;
+	{
+		std::lock_guard lock(m_requests_mtx);
+		auto it = m_requests.find(packet->getRequestID());
+		if (it == m_requests.end()) return;
+		callback = std::move(it->second);
+		m_requests.erase(it);
+	}
+	callback(std::move(packet));
 }
 
 bool Page::send_packet(class Packet const& packet, std::function<void(std::unique_ptr<class Packet>)> callback)
@@ -131,34 +154,46 @@ bool Page::send_packet(class Packet const& packet, std::function<void(std::uniqu
 	auto connection = view->get_connection();
 
 	if (!callback) {
-		connection->sendData(packet);
-		return true;
+		return connection->sendData(packet);
 	}
 
-	std::mutex mtx;
-	std::condition_variable cv;
-	std::unique_ptr<Packet> response;
-	bool responded = false;
-
-	m_requests.emplace_back(std::pair(packet.getRequestID(), [&](std::unique_ptr<Packet> pkt) {
-		{
-			std::lock_guard<std::mutex> lock(mtx);
-			response = std::move(pkt);
-			responded = true;
-		}
-		cv.notify_one();
-	}));
+	// Owned together with the entry in m_requests, an answer coming after the timeout finds it alive
+	struct Waiter {
+		std::mutex mtx;
+		std::condition_variable cv;
+		std::unique_ptr<Packet> response;
+		bool responded = false;
+	};
+	auto waiter = std::make_shared<Waiter>();
+	const auto requestID = packet.getRequestID();
+
+	{
+		std::lock_guard lock(m_requests_mtx);
+		m_requests.insert_or_assign(requestID, [waiter](std::unique_ptr<Packet> pkt) {
+			{
+				std::lock_guard<std::mutex> lock(waiter->mtx);
+				waiter->response = std::move(pkt);
+				waiter->responded = true;
+			}
+			waiter->cv.notify_one();
+		});
+	}
 
-	connection->sendData(packet);
+	bool answered = connection->sendData(packet);
+	if (answered) {
+		std::unique_lock<std::mutex> lock(waiter->mtx);
+		answered = waiter->cv.wait_for(lock, std::chrono::milliseconds(5000), [&] { return waiter->responded; });
+	}
 
-	std::unique_lock<std::mutex> lock(mtx);
-	if (!cv.wait_for(lock, std::chrono::milliseconds(5000), [&] { return responded; })) {
+	if (!answered) {
+		std::lock_guard lock(m_requests_mtx);
+		m_requests.erase(requestID);
 		return false;
 	}
 
-	if (!response) return false;
+	if (!waiter->response) return false;
 
-	callback(std::move(response));
+	callback(std::move(waiter->response));
 	return true;
 }
 
@@ -167,24 +202,56 @@ bool Page::send_packet_async(class Packet const& packet, std::function<void(std:
 	auto view = m_view.lock();
 	if (!view) return false;
 
-
-	m_requests.emplace_back(std::pair(packet.getRequestID(), [callback = std::move(callback), this](std::unique_ptr<Packet> pkt) {
-		if (!pkt) return;
-		auto buf = std::make_shared<std::unique_ptr<Packet>>(std::move(pkt));
-		m_func_queue.push([buf, cb = std::move(callback), this]() mutable {
-			cb(std::move(*buf));
+	const auto requestID = packet.getRequestID();
+	{
+		std::lock_guard lock(m_requests_mtx);
+		m_requests.insert_or_assign(requestID, [callback = std::move(callback), this](std::unique_ptr<Packet> pkt) {
+			if (!pkt) return;
+			auto buf = std::make_shared<std::unique_ptr<Packet>>(std::move(pkt));
+			this->push_draw_task([buf, cb = std::move(callback)]() mutable {
+				cb(std::move(*buf));
+			});
 		});
-	}));
+	}
 
 	auto connection = view->get_connection();
-	connection->sendData(packet);
+	if (connection->sendData(packet)) return true;
 
-	return true;
+	std::lock_guard lock(m_requests_mtx);
+	m_requests.erase(requestID);
+	return false;
+}
+
+void Page::subscribe(TableID table)
+{
+	m_feed_table = table;
+	SubscribePacket sp(table);
+	this->send_packet(sp);
+}
+
+void Page::begin_load()
+{
+	m_feed_loading = true;
+}
+
+void Page::end_load(uint64_t sequence)
+{
+	// The answer replaced what the deltas were applied to, the ones it
+	// does not contain yet go on top. Everything older came before it
+	m_feed_loading = false;
+	m_feed_sequence = sequence;
+
+	auto pending = std::move(m_feed_pending);
+	m_feed_pending.clear();
+	for (auto const& change : pending) {
+		if (change->sequence > sequence) this->on_row_change(*change);
+	}
 }
 
 void Page::push_draw_task(std::function<void()> task)
 {
-	m_func_queue.push(task);
+	std::lock_guard lock(m_func_mtx);
+	m_func_queue.push(std::move(task));
 }
 
 PageID Page::get_id() const {
@@ -1,7 +1,12 @@
 #pragma once
 #include <litehtml.h>
 #include "../../Utils/Json.hpp"
+#include "../../Network/Core/DatabaseSchema.hpp"
 #include <queue>
+#include <mutex>
+#include <functional>
+#include <unordered_map>
+#include <vector>
 
 enum class PageID
 {
@@ -14,7 +19,7 @@ enum class PageID
 
 class Page {
 	using weak_custom_elements_list = std::vector<std::weak_ptr<class custom_element>>;
-	using requests_list = std::vector<std::pair<uint64_t, std::function<void(std::unique_ptr<class Packet>)>>>;
+	using requests_list = std::unordered_map<uint64_t, std::function<void(std::unique_ptr<class Packet>)>>;
 	using functions_queue = std::queue<std::function<void()>>;
 protected:
 	std::string							m_html;
@@ -22,12 +27,30 @@ protected:
 	std::weak_ptr<class HtmlView>		m_view;
 	weak_custom_elements_list			m_custom_elements;
 	PageID								m_id;
+	// Answers arrive on the receiving thread in any order, matched by request id
+	std::mutex							m_requests_mtx;
 	requests_list						m_requests;
+	std::mutex							m_func_mtx;
 	functions_queue						m_func_queue;
+	// Change feed of the table the page shows, touched by draw tasks only. While a
+	// load is in flight its deltas are applied and kept, the ones newer than the
+	// answer's snapshot are applied again on top of it, see end_load
+	TableID								m_feed_table = TableID::USERS;
+	uint64_t							m_feed_sequence = 0;
+	bool								m_feed_loading = false;
+	std::vector<std::unique_ptr<class RowChangePacket>>	m_feed_pending;
 
+	// Blocks until the answer came or 5 s passed, only for answers that decide
+	// what the caller does next. Everything else should use send_packet_async
 	bool send_packet(class Packet const& packet, std::function<void(std::unique_ptr<class Packet>)> callback = nullptr);
 	bool send_packet_async(class Packet const& packet, std::function<void(std::unique_ptr<class Packet>)> callback);
 	void push_draw_task(std::function<void()> task);
+
+	// Subscriptions live as long as the connection, a resumed session subscribes again
+	void subscribe(TableID table);
+	// Bracket a GetData of the subscribed table, sequence is the one its answer carries
+	void begin_load();
+	void end_load(uint64_t sequence);
 public:
 	Page(std::shared_ptr<class HtmlView> view);
 	Page() = delete;
@@ -38,6 +61,10 @@ public:
 	virtual void on_switch(nlohmann::json = nlohmann::json::object()) = 0;
 
 	virtual void on_packet_receive(std::unique_ptr<class Packet> packet);
+	// A row of a table the page subscribed to changed on the server, runs as a draw task
+	virtual void on_row_change(class RowChangePacket const& change) { }
+	// The connection was lost and the session resumed on a new one, runs on the receiving thread
+	virtual void on_session_resumed() { }
 
 	void draw(litehtml::uint_ptr hdc, int x, int y, const litehtml::position* clip);
 	void on_key_down(uint32_t vKey, uint16_t keyMode);
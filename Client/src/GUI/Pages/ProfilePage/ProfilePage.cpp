@@ -1,11 +1,13 @@
 #include "ProfilePage.hpp"
 #include "../../HtmlView/HtmlView.hpp"
 #include "../../../Network/PacketManager/PacketManager.hpp"
+#include "../../../Network/Client/Client.hpp"
+#include "../../../Network/Core/ResultSet.hpp"
 #include "../../Elements/el_input.hpp"
+#include "../../../Utils/Validators.hpp"
 
 #include <litehtml/el_tr.h>
 #include <litehtml/el_td.h>
-#include <regex>
 #include <print>
 #include <algorithm>
 
@@ -108,16 +110,11 @@ void ProfilePage::register_user_action()
     std::string surname_value = surname->get_value();
     std::string phone_value = phone->get_value();
 
-    std::regex email_regex(R"(^[A-Za-z0-9._%+-]+@[A-Za-z0-9.-]+\.[A-Za-z]{2,}$)");
-    std::regex phone_regex(R"(^$|^\+?\d{10,15}$)");
-    std::regex name_regex(R"(^[A-Za-zА-Яа-яЁё]{1,20}$)");
-    std::regex password_regex(R"(^.{8,}$)");
-
-    bool is_email_valid = std::regex_match(email_value, email_regex);
-    bool is_phone_valid = std::regex_match(phone_value, phone_regex);
-    bool is_password_valid = std::regex_match(password_value, password_regex);
-    bool is_name_valid = std::regex_match(name_value, name_regex);
-    bool is_surname_valid = std::regex_match(surname_value, name_regex);
+    bool is_email_valid = Validators::isEmail(email_value);
+    bool is_phone_valid = Validators::isPhone(phone_value);
+    bool is_password_valid = Validators::isPassword(password_value);
+    bool is_name_valid = Validators::isName(name_value);
+    bool is_surname_valid = Validators::isName(surname_value);
     bool error = !is_email_valid || !is_phone_valid || !is_password_valid || !is_name_valid || !is_surname_valid;
 
     auto email_err = m_doc->root()->select_one("#email-err");
@@ -258,13 +255,9 @@ void ProfilePage::edit_data_action()
     std::string phone_value = phone->get_value();
     std::string role_value = role->get_value();
 
-    std::regex email_regex(R"(^[A-Za-z0-9._%+-]+@[A-Za-z0-9.-]+\.[A-Za-z]{2,}$)");
-    std::regex phone_regex(R"(^$|^\+?\d{10,15}$)");
-    std::regex password_regex(R"(^.{8,}$)");
-
-    bool is_email_valid = std::regex_match(email_value, email_regex);
-    bool is_phone_valid = std::regex_match(phone_value, phone_regex);
-    bool is_password_valid = std::regex_match(password_value, password_regex) || password_value == "";
+    bool is_email_valid = Validators::isEmail(email_value);
+    bool is_phone_valid = Validators::isPhone(phone_value);
+    bool is_password_valid = Validators::isPassword(password_value) || password_value == "";
     bool error = !is_email_valid || !is_phone_valid || !is_password_valid;
 
     auto email_err = m_doc->root()->select_one("#edit-email-err");
@@ -446,6 +439,7 @@ bool ProfilePage::on_element_click(const litehtml::element::ptr& el)
     if(id == nullptr) return false;
 
     if (!strcmp(id, "logout-button")) {
+        view->get_connection()->setSessionToken("");
         this->send_packet(LogoutPacket());
         view->switch_page(PageID::LOGIN);
         return true;
@@ -501,7 +495,7 @@ void ProfilePage::on_switch(nlohmann::json userData) {
     m_users.clear();
     m_user_to_edit = { };
 
-    auto safe_get = [](const nlohmann::json& obj, const std::string& key) -> std::string {
+    auto safe_get = [](const auto& obj, const std::string& key) -> std::string {
         if (!obj.contains(key) || obj[key].is_null()) return "";
 
         const auto& val = obj[key];
@@ -531,7 +525,7 @@ void ProfilePage::on_switch(nlohmann::json userData) {
         m_current_user = CurrentUser(safe_cast<long long>(safe_get(userData, "id")), safe_get(userData, "name"), safe_get(userData, "surname"), safe_get(userData, "role"));
     }
 
-    this->send_packet(gdp, [this, safe_get = safe_get, userData = std::move(userData)](std::unique_ptr<Packet> packet) {
+    this->send_packet_async(gdp, [this, safe_get = safe_get, userData = std::move(userData)](std::unique_ptr<Packet> packet) {
         if (packet->getID() != PacketID::Response) return;
 
         auto view = m_view.lock();
@@ -547,7 +541,7 @@ void ProfilePage::on_switch(nlohmann::json userData) {
 
         std::string html;
 
-        for (const auto& user : data) {
+        for (const auto& user : ResultSet(data)) {
             html += "<tr>";
 
             std::vector<std::string> fields;
@@ -1,11 +1,12 @@
 #include "RoomsPage.hpp"
 #include "../../HtmlView/HtmlView.hpp"
 #include "../../../Network/PacketManager/PacketManager.hpp"
+#include "../../../Network/Core/ResultSet.hpp"
 #include "../../Elements/el_input.hpp"
+#include "../../../Utils/Validators.hpp"
 
 #include <litehtml/el_tr.h>
 #include <litehtml/el_td.h>
-#include <regex>
 #include <print>
 
 template<typename T>
@@ -17,6 +18,42 @@ static T safe_cast(const std::string& str) {
     return (result.ec == std::errc() && result.ptr == str.data() + str.size()) ? value : T{};
 }
 
+static std::string room_value(const nlohmann::json& val) {
+    if (val.is_null()) return "";
+
+    if (val.is_string()) {
+        return val.get<std::string>();
+    }
+    else if (val.is_number_integer()) {
+        return std::to_string(val.get<int64_t>());
+    }
+    else if (val.is_number_unsigned()) {
+        return std::to_string(val.get<uint64_t>());
+    }
+    else if (val.is_number_float()) {
+        return std::format("{:.2f}", val.get<double>());
+    }
+    else if (val.is_boolean()) {
+        return val.get<bool>() ? "true" : "false";
+    }
+
+    return val.dump();
+}
+
+// Fields of a GetData row or a RowChangePacket row, in table column order
+template<typename Row>
+static std::vector<std::pair<std::string, std::string>> make_room(Row const& row) {
+    const static std::vector<std::string> keys = {
+        "id", "room_type", "price_per_night", "capacity", "availability", "description"
+    };
+
+    std::vector<std::pair<std::string, std::string>> room;
+    for (auto const& key : keys) {
+        room.push_back(std::make_pair(key, row.contains(key) ? room_value(row[key]) : ""));
+    }
+    return room;
+}
+
 bool RoomsPage::init()
 {
     auto view = m_view.lock();
@@ -61,7 +98,9 @@ void RoomsPage::delete_data(litehtml::element::ptr const& el)
             return;
         }
 
-        view->switch_page(PageID::ROOMS);
+        // The row is already gone, the server pushed the change ahead of this response
+        this->show_rooms();
+        view->render();
     });
 }
 
@@ -136,13 +175,9 @@ void RoomsPage::edit_data_action()
     std::string availability_value = availability->get_value();
     std::string description_value = description->get_value();
 
-    std::regex price_regex(R"(^\d+[.,]\d+$)");
-    std::regex capacity_regex(R"(^\d+$)");
-    std::regex availability_regex(R"(^[01]$)");
-
-    bool is_price_valid = std::regex_match(price_per_night_value, price_regex);
-    bool is_capacity_valid = std::regex_match(capacity_value, capacity_regex);
-    bool is_availability_valid = std::regex_match(availability_value, availability_regex);
+    bool is_price_valid = Validators::isPrice(price_per_night_value);
+    bool is_capacity_valid = Validators::isUnsigned(capacity_value);
+    bool is_availability_valid = Validators::isFlag(availability_value);
     bool error = !is_price_valid || !is_capacity_valid || !is_availability_valid;
 
     auto edit_price_err = m_doc->root()->select_one("#edit-price-err");
@@ -190,7 +225,9 @@ void RoomsPage::edit_data_action()
             return;
         }
 
-        view->switch_page(PageID::ROOMS);
+        this->show_rooms();
+        view->reset_scroll();
+        view->render();
     });
 }
 
@@ -233,13 +270,9 @@ void RoomsPage::register_room_action()
     std::string availability_value = availability->get_value();
     std::string description_value = description->get_value();
 
-    std::regex price_regex(R"(^\d+[.,]\d+$)");
-    std::regex capacity_regex(R"(^\d+$)");
-    std::regex availability_regex(R"(^[01]$)");
-
-    bool is_price_valid = std::regex_match(price_per_night_value, price_regex);
-    bool is_capacity_valid = std::regex_match(capacity_value, capacity_regex);
-    bool is_availability_valid = std::regex_match(availability_value, availability_regex);
+    bool is_price_valid = Validators::isPrice(price_per_night_value);
+    bool is_capacity_valid = Validators::isUnsigned(capacity_value);
+    bool is_availability_valid = Validators::isFlag(availability_value);
     bool error = !is_price_valid || !is_capacity_valid || !is_availability_valid;
 
     auto edit_price_err = m_doc->root()->select_one("#reg-price-err");
@@ -277,7 +310,9 @@ void RoomsPage::register_room_action()
         auto response = dynamic_cast<ResponsePacket*>(packet.get());
 
         if (response->errorCode == ResponseID::Sucess) {
-            view->switch_page(PageID::ROOMS);
+            this->show_rooms();
+            view->reset_scroll();
+            view->render();
         }
         else {
             auto reg_err = m_doc->root()->select_one("#reg-err");
@@ -294,19 +329,9 @@ void RoomsPage::register_room_action()
 
 void RoomsPage::sort_data(std::string&& field_name)
 {
-    auto get_field = [](const room_data_t& data, const std::string& key) -> std::string {
-        for (const auto& pair : data) {
-            if (pair.first == key)
-                return pair.second;
-        }
-        return "";
-    };
-
     auto view = m_view.lock();
     if (!view) return;
 
-    auto sorted_rooms = sorted_rooms_t(m_rooms.begin(), m_rooms.end());
-
     auto input_sort = std::dynamic_pointer_cast<el_input>(m_doc->root()->select_one("#input-sort"));
     auto& sort_value = input_sort->get_value();
 
@@ -318,6 +343,37 @@ void RoomsPage::sort_data(std::string&& field_name)
         }
     }
     m_last_sort_value = sort_value;
+    m_current_sort = std::make_pair(std::move(field_name), sort_type);
+
+    this->push_draw_task([this]() {
+        auto view = m_view.lock();
+        if (!view) return;
+
+        this->show_rooms();
+        view->reset_scroll();
+        view->render();
+    });
+}
+
+void RoomsPage::show_rooms()
+{
+    auto get_field = [](const room_data_t& data, const std::string& key) -> std::string {
+        for (const auto& pair : data) {
+            if (pair.first == key)
+                return pair.second;
+        }
+        return "";
+    };
+
+    auto view = m_view.lock();
+    if (!view) return;
+
+    auto sorted_rooms = sorted_rooms_t(m_rooms.begin(), m_rooms.end());
+
+    // Rooms come in id order until a column header is clicked
+    auto const& field_name = m_current_sort.first.empty() ? std::string("id") : m_current_sort.first;
+    auto const sort_type = m_current_sort.second;
+    auto const& sort_value = m_last_sort_value;
 
     std::sort(sorted_rooms.begin(), sorted_rooms.end(), [&](const auto& u1, const auto& u2) {
         auto compare = [&]<typename T>(T const& arg1, T const& arg2) -> bool {
@@ -382,45 +438,59 @@ void RoomsPage::sort_data(std::string&& field_name)
         );
     }
 
-    m_current_sort = std::make_pair(std::move(field_name), sort_type);
+    std::string html;
 
-    this->push_draw_task([sort_value = std::move(sort_value), sorted_rooms = std::move(sorted_rooms), this]() {
-        auto view = m_view.lock();
-        if (!view) return;
+    for (const auto& room : sorted_rooms) {
+        html += "<tr>";
 
-        std::string html;
+        for (auto const& field : room.second) {
+            html += std::format(R"(<td>{}</td>)", field.second);
+        }
 
-        for (const auto& room : sorted_rooms) {
-            html += "<tr>";
+        html += std::format(
+            R"(<td class="link" id="edit-record-button" data-record-id="{}">Изменить</td><td class="link" id="delete-record-button" data-record-id="{}">Удалить</td>)",
+            room.first,
+            room.first
+        );
 
-            for (auto const& field : room.second) {
-                html += std::format(R"(<td>{}</td>)", field.second);
-            }
+        html += "</tr>";
+    }
 
-            html += std::format(
-                R"(<td class="link" id="edit-record-button" data-record-id="{}">Изменить</td><td class="link" id="delete-record-button" data-record-id="{}">Удалить</td>)",
-                room.first,
-                room.first
-            );
+    html = HtmlView::replace_placeholder(m_html, "{{ROWS}}", html);
+    m_doc = litehtml::document::createFromString(html, view.get());
 
-            html += "</tr>";
-        }
+    if (auto deletion_err = m_doc->root()->select_one("#deletion-err")) {
+        auto reg_err_text = std::make_shared<el_textholder>("", m_doc);
+        reg_err_text->appendTo(deletion_err);
+    }
 
-        html = HtmlView::replace_placeholder(m_html, "{{ROWS}}", html);
-        m_doc = litehtml::document::createFromString(html, view.get());
+    if (auto input_sort = std::dynamic_pointer_cast<el_input>(m_doc->root()->select_one("#input-sort"))) {
+        input_sort->value(sort_value, true);
+    }
+}
 
-        view->reset_scroll();
+void RoomsPage::on_row_change(RowChangePacket const& change)
+{
+    if (change.table != TableID::ROOMS) return;
 
-        if (auto deletion_err = m_doc->root()->select_one("#deletion-err")) {
-            auto reg_err_text = std::make_shared<el_textholder>("", m_doc);
-            reg_err_text->appendTo(deletion_err);
-        }
+    auto id = std::to_string(change.rowID);
+    if (change.change == RowChange::Deleted) m_rooms.erase(id);
+    else m_rooms.insert_or_assign(id, make_room(change.row));
 
-        auto input_sort = std::dynamic_pointer_cast<el_input>(m_doc->root()->select_one("#input-sort"));
-        input_sort->value(sort_value, true);
+    // An open form is left alone, the table picks the change up once it is shown again
+    auto input_sort = m_doc ? std::dynamic_pointer_cast<el_input>(m_doc->root()->select_one("#input-sort")) : nullptr;
+    if (!input_sort) return;
 
-        view->render();
-        });
+    auto view = m_view.lock();
+    if (!view) return;
+
+    // Keep whatever is typed into the filter but not applied yet
+    auto typed = input_sort->get_value();
+    this->show_rooms();
+    if (auto new_input = std::dynamic_pointer_cast<el_input>(m_doc->root()->select_one("#input-sort"))) {
+        new_input->value(typed, true);
+    }
+    view->render();
 }
 
 bool RoomsPage::on_element_click(const litehtml::element::ptr& el)
@@ -453,7 +523,10 @@ bool RoomsPage::on_element_click(const litehtml::element::ptr& el)
             auto view = m_view.lock();
             if (!view) return;
 
-            view->switch_page(PageID::ROOMS);
+            // m_rooms is kept current by the change feed, no need to fetch it again
+            this->show_rooms();
+            view->reset_scroll();
+            view->render();
         });
         return true;
     }
@@ -482,37 +555,34 @@ bool RoomsPage::on_element_click(const litehtml::element::ptr& el)
     return false;
 }
 
+void RoomsPage::on_session_resumed() {
+    // Changes made while the connection was down never came, fetch the table again
+    this->push_draw_task([this]() {
+        this->subscribe(TableID::ROOMS);
+        this->load_rooms(nlohmann::json::object(), true);
+    });
+}
+
 void RoomsPage::on_switch(nlohmann::json data) {
-    GetDataPacket gdp(TableID::ROOMS);
+    // Changes committed while the fetch runs are put in order by their sequence, see Page::end_load
+    this->subscribe(TableID::ROOMS);
+
     m_rooms.clear();
     m_room_to_edit = { };
+    m_current_sort = { };
+    m_last_sort_value.clear();
 
-    auto safe_get = [](const nlohmann::json& obj, const std::string& key) -> std::string {
-        if (!obj.contains(key) || obj[key].is_null()) return "";
-
-        const auto& val = obj[key];
-
-        if (val.is_string()) {
-            return val.get<std::string>();
-        }
-        else if (val.is_number_integer()) {
-            return std::to_string(val.get<int64_t>());
-        }
-        else if (val.is_number_unsigned()) {
-            return std::to_string(val.get<uint64_t>());
-        }
-        else if (val.is_number_float()) {
-            return std::format("{:.2f}", val.get<double>());
-        }
-        else if (val.is_boolean()) {
-            return val.get<bool>() ? "true" : "false";
-        }
+    this->load_rooms(std::move(data));
+}
 
-        return val.dump();
-        };
+void RoomsPage::load_rooms(nlohmann::json roomData, bool resumed)
+{
+    GetDataPacket gdp(TableID::ROOMS);
 
-    this->send_packet(gdp, [this, safe_get = safe_get, roomData = std::move(data)](std::unique_ptr<Packet> packet) {
-        if (packet->getID() != PacketID::Response) return;
+    m_load_request = gdp.getRequestID();
+    this->begin_load();
+    this->send_packet_async(gdp, [this, roomData = std::move(roomData), resumed, request = m_load_request](std::unique_ptr<Packet> packet) {
+        if (packet->getID() != PacketID::Response || request != m_load_request) return;
 
         auto view = m_view.lock();
         if (!view) return;
@@ -520,50 +590,24 @@ void RoomsPage::on_switch(nlohmann::json data) {
         auto* response = dynamic_cast<ResponsePacket*>(packet.get());
         auto& data = response->additionalData;
 
-        std::vector<std::string> keys = {
-            "id", "room_type", "price_per_night", "capacity", "availability", "description"
-        };
-
-        std::string html;
-
-        for (const auto& room : data) {
-            html += "<tr>";
-
-            std::vector<std::string> fields;
-            for (const auto& key : keys) {
-                auto field = safe_get(room, key);
-                fields.emplace_back(std::move(field));
-            }
-
-            std::vector<std::pair<std::string, std::string>> room;
-            for (size_t i = 0; i < fields.size(); ++i) {
-                room.push_back(std::make_pair(keys[i], fields[i]));
-                html += std::format(R"(<td>{}</td>)", fields[i]);
-            }
-            
-            m_rooms.insert({ fields[0], std::move(room) });
-            html += std::format(
-                R"(<td class="link" id="edit-record-button" data-record-id="{}">Изменить</td><td class="link" id="delete-record-button" data-record-id="{}">Удалить</td>)",
-                fields[0],
-                fields[0]
-            );
-
-            html += "</tr>";
+        m_rooms.clear();
+        for (const auto& row : ResultSet(data)) {
+            auto room = make_room(row);
+            auto id = room[0].second;
+            m_rooms.insert({ std::move(id), std::move(room) });
         }
 
-        html = HtmlView::replace_placeholder(m_html, "{{ROWS}}", html);
-        m_doc = litehtml::document::createFromString(html, view.get());
+        this->end_load(response->sequence);
 
-        view->reset_scroll();
+        // An open form is left alone, the table shows the rows once it is back
+        if (resumed && !m_doc->root()->select_one("#input-sort")) return;
 
-        if (auto deletion_err = m_doc->root()->select_one("#deletion-err")) {
-            auto reg_err_text = std::make_shared<el_textholder>("", m_doc);
-            reg_err_text->appendTo(deletion_err);
-        }
+        this->show_rooms();
+        view->reset_scroll();
 
         if (roomData.contains("room_id")) {
             auto input_sort = std::dynamic_pointer_cast<el_input>(m_doc->root()->select_one("#input-sort"));
-            input_sort->value(safe_get(roomData, "room_id"), true);
+            input_sort->value(room_value(roomData["room_id"]), true);
             this->sort_data("id");
         }
 
@@ -19,6 +19,8 @@ private:
 	std::string		m_edit_room_html;
 	std::string		m_add_room_html;
 	std::string		m_last_sort_value;
+	// Loads may be answered out of order, only the latest one is shown
+	uint64_t		m_load_request = 0;
 public:
 	RoomsPage(std::shared_ptr<HtmlView> view);
 	~RoomsPage() = default;
@@ -29,9 +31,13 @@ public:
 	void register_room_action();
 	void edit_data_action();
 	void sort_data(std::string&& field);
+	void show_rooms();
+	void load_rooms(nlohmann::json roomData = nlohmann::json::object(), bool resumed = false);
 
 	bool init() override;
 	bool on_element_click(const litehtml::element::ptr& el) override;
 	void on_switch(nlohmann::json = nlohmann::json::object()) override;
+	void on_row_change(class RowChangePacket const& change) override;
+	void on_session_resumed() override;
 
 };
\ No newline at end of file
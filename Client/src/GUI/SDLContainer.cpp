@@ -171,6 +171,11 @@ void SDLContainer::on_packet_receive(std::unique_ptr<class Packet> packet)
     m_view->on_packet_receive(std::move(packet));
 }
 
+void SDLContainer::on_session_resumed()
+{
+    m_view->on_session_resumed();
+}
+
 void SDLContainer::render()
 {
     m_view->needsUpdate = true;
@@ -26,6 +26,7 @@ public:
     void AppQuit(SDL_AppResult result);
 
     void on_packet_receive(std::unique_ptr<class Packet> packet);
+    void on_session_resumed();
     void render();
 
 private:
@@ -1,14 +1,16 @@
 #include "Client.hpp"
 #include "../../Utils/Json.hpp"
 #include "../../Utils/base64.hpp"
+#include "../../Utils/BinaryStream.hpp"
 #include "../PacketManager/PacketManager.hpp"
 #include "../../GUI/SDLContainer.hpp"
 
 #include <mstcpip.h>
 #include <WS2tcpip.h>
 #include <print>
+#include <thread>
 
-Client::Client(SDLContainer* con) : m_thread_pool(ThreadPool()), m_status(SocketStatus::disconnected), m_address(NULL), m_socket(NULL), m_container(con), m_ssl(nullptr), m_ctx(nullptr)
+Client::Client(SDLContainer* con) : m_status(SocketStatus::disconnected), m_thread_pool(ThreadPool()), m_container(con), m_ctx(nullptr), m_wire_format(WireFormat::json), m_generation(0), m_host(0), m_port(0), m_resume_request(0), m_resuming(false), m_closed(false)
 {
 	if (auto err = WSAStartup(MAKEWORD(2, 2), &m_wData); err != 0) {
 		char buffer[256];
@@ -41,92 +43,196 @@ SocketStatus Client::connectTo(std::string const& host, uint16_t port) noexcept
 }
 
 SocketStatus Client::connectTo(uint32_t host, uint16_t port) noexcept {
-    if ((this->m_socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_IP)) == INVALID_SOCKET)
+    {
+        std::lock_guard lock(m_conn_mtx);
+        m_host = host;
+        m_port = port;
+    }
+
+    // Connected outside the lock, only the finished connection is swapped in
+    SOCKET socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+    if (socket == INVALID_SOCKET)
         return m_status = SocketStatus::err_socket_init;
 
-    new(&this->m_address) SOCKADDR_IN;
-    this->m_address.sin_family = AF_INET;
-    this->m_address.sin_addr.s_addr = host;
-    this->m_address.sin_port = htons(port);
+    SOCKADDR_IN address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = host;
+    address.sin_port = htons(port);
 
-    if (connect(this->m_socket, reinterpret_cast<sockaddr*>(&m_address), sizeof(m_address)) == SOCKET_ERROR) {
-        closesocket(m_socket);
+    if (connect(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR) {
+        closesocket(socket);
         return this->m_status = SocketStatus::err_socket_connect;
     }
 
-    m_ssl = SSL_new(m_ctx);
-    if (!m_ssl) {
+    SSL* ssl = SSL_new(m_ctx);
+    if (!ssl) {
         std::println(stderr, "Failed to create SSL structure.");
         ERR_print_errors_fp(stderr);
-        closesocket(m_socket);
+        closesocket(socket);
         return this->m_status = SocketStatus::err_ssl_init;
     }
 
-    SSL_set_fd(m_ssl, static_cast<int>(m_socket));
-    SSL_set_verify(m_ssl, SSL_VERIFY_NONE, nullptr);
+    SSL_set_fd(ssl, static_cast<int>(socket));
+    SSL_set_verify(ssl, SSL_VERIFY_NONE, nullptr);
 
-    if (SSL_connect(m_ssl) <= 0) {
+    if (SSL_connect(ssl) <= 0) {
         std::println(stderr, "SSL_connect failed.");
         ERR_print_errors_fp(stderr);
-        SSL_free(m_ssl);
-        m_ssl = nullptr;
-        closesocket(m_socket);
+        SSL_free(ssl);
+        closesocket(socket);
         return this->m_status = SocketStatus::err_ssl_connect;
     }
 
-    this->m_thread_pool.addJob(std::bind(&Client::dataReceivingLoop, this));
-    return this->m_status = SocketStatus::connected;
+    auto conn = std::make_shared<Connection>(socket, ssl, 0);
+    {
+        std::lock_guard lock(m_conn_mtx);
+        // Connected already or closed meanwhile, the new one goes away with conn
+        if (m_conn || m_closed) return this->m_status;
+
+        conn->generation = ++m_generation;
+        m_conn = conn;
+        m_status = SocketStatus::connected;
+    }
+
+    this->m_thread_pool.addJob([this, conn] { this->dataReceivingLoop(conn); });
+    return SocketStatus::connected;
 }
 
 SocketStatus Client::disconnect(bool forced) noexcept
-{  
-    if (this->m_status != SocketStatus::connected)
-        return this->m_status;
+{
+    uint64_t generation;
+    {
+        std::lock_guard lock(m_conn_mtx);
+        // For good, a resume still running won't connect again
+        if (!forced) m_closed = true;
+        if (!m_conn) return this->m_status;
+        generation = m_conn->generation;
+    }
 
-    this->m_status = SocketStatus::disconnected;
+    this->connectionLost(generation);
+    return this->m_status;
+}
 
-    if (m_ssl) {
-        int shutdown_status = SSL_shutdown(m_ssl);
-        if (shutdown_status == 0) {
-            SSL_shutdown(m_ssl);
-        }
-        SSL_free(m_ssl);
-        m_ssl = nullptr;
-    }
+bool Client::teardown(uint64_t generation) noexcept
+{
+    std::lock_guard lock(m_conn_mtx);
+    if (!m_conn || m_conn->generation != generation) return false;
+
+    // Wakes a reader blocked in SSL_read, the SSL lives on until it lets go
+    shutdown(m_conn->socket, SD_BOTH);
+    m_conn.reset();
+    m_status = SocketStatus::disconnected;
+    return true;
+}
+
+void Client::connectionLost(uint64_t generation) noexcept
+{
+    // An error of a connection already replaced must not take the new one down
+    if (!this->teardown(generation) || m_closed) return;
+
+    // One resume at a time, a running one deals with its own attempts failing
+    bool expected = false;
+    if (!m_resuming.compare_exchange_strong(expected, true)) return;
 
-    if (m_socket != INVALID_SOCKET) {
-        shutdown(m_socket, SD_BOTH);
-        closesocket(m_socket);
-        m_socket = INVALID_SOCKET;
+    // The backoff sleeps on the pool, never on the thread that hit the error
+    this->m_thread_pool.addJob([this] { this->resumeSession(); });
+}
+
+void Client::setSessionToken(std::string token)
+{
+    std::lock_guard lock(m_session_mtx);
+    m_session_token = std::move(token);
+}
+
+void Client::resumeSession()
+{
+    static constexpr int attempts = 3;
+
+    std::string token;
+    {
+        std::lock_guard lock(m_session_mtx);
+        token = m_session_token;
+    }
+    uint32_t host;
+    uint16_t port;
+    {
+        std::lock_guard lock(m_conn_mtx);
+        host = m_host;
+        port = m_port;
     }
 
-    if (forced) {
-        MessageBoxA(NULL, "Connection to server lost!", "Fatal Error", MB_ICONERROR | MB_OK);
-        exit(1);
+    // A short outage is survived without asking for the password again
+    for (int attempt = 0; !token.empty() && attempt < attempts && !m_closed; ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(500) * (attempt + 1));
+        if (this->connectTo(host, port) != SocketStatus::connected) continue;
+
+        ResumeSessionPacket packet(token);
+        m_resume_request = packet.getRequestID();
+        if (!this->sendData(packet)) continue;
+
+        // Lost again before the claim was given up, nobody else took it over then
+        m_resuming = false;
+        bool expected = false;
+        if (m_status == SocketStatus::connected || !m_resuming.compare_exchange_strong(expected, true))
+            return;
     }
 
-    return this->m_status;
+    m_resuming = false;
+    if (m_closed) return;
+
+    MessageBoxA(NULL, "Connection to server lost!", "Fatal Error", MB_ICONERROR | MB_OK);
+    exit(1);
 }
 
-void Client::dataReceivingLoop()
+void Client::dataReceivingLoop(std::shared_ptr<Connection> const& conn)
 {
-    if (const auto& data = this->receiveData(); !data.empty()) {
-        auto badPacket_func = [this] {
+    if (const auto& data = this->receiveData(*conn); !data.empty()) {
+        auto badPacket_func = [this, &conn] {
             std::println(stderr, "Bad Packet Error!");
-            this->disconnect();
+            this->connectionLost(conn->generation);
         };
         try {
-            std::string rawData(data.begin(), data.end());
-            rawData = base64::from_base64(rawData);
-
-            nlohmann::json json = nlohmann::json::parse(rawData);
+            std::unique_ptr<Packet> packet;
+            if (data.front() == BinaryStream::magic) {
+                BinaryReader reader(data.data(), data.size());
+                packet = PacketManager::CreatePacket(reader);
+            }
+            else {
+                std::string rawData(data.begin(), data.end());
+                rawData = base64::from_base64(rawData);
+
+                nlohmann::json json = nlohmann::json::parse(rawData);
+                packet = PacketManager::CreatePacket(json);
+
+                // The server understands the binary encoding, use it from now on
+                if (json.value("wire", 0u) >= BinaryStream::version)
+                    m_wire_format = WireFormat::binary;
+            }
 
-            auto packet = PacketManager::CreatePacket(json);
             if (packet->getID() == PacketID::Unknown) { badPacket_func(); }
 
             std::println("Received {} from Server", packet->getName());
 
-            this->m_thread_pool.addJob(std::bind(&Client::dataReceivingLoop, this));
+            // The answer to our own ResumeSessionPacket, pages never asked for it
+            if (m_resume_request != 0 && packet->getRequestID() == m_resume_request) {
+                m_resume_request = 0;
+                this->m_thread_pool.addJob([this, conn] { this->dataReceivingLoop(conn); });
+
+                auto response = dynamic_cast<ResponsePacket*>(packet.get());
+                if (!response || response->errorCode != ResponseID::Sucess) {
+                    // The session is gone, nothing left to fall back on
+                    this->setSessionToken("");
+                    this->connectionLost(conn->generation);
+                    return;
+                }
+
+                // The server dropped the old connection's subscriptions with it
+                m_container->on_session_resumed();
+                m_container->render();
+                return;
+            }
+
+            this->m_thread_pool.addJob([this, conn] { this->dataReceivingLoop(conn); });
             m_container->on_packet_receive(std::move(packet));
             m_container->render();
         }
@@ -138,13 +244,22 @@ void Client::dataReceivingLoop()
 
 bool Client::sendData(class Packet const& packet) const
 {
-    auto rawData = base64::to_base64(packet.toString());
+    if (m_wire_format == WireFormat::binary) {
+        auto binData = packet.toBinary();
+        return this->sendData(binData.data(), binData.size());
+    }
+
+    // Tells the server we accept additional_data as a nested value
+    auto json = packet.toJSON();
+    json["inline_data"] = true;
+
+    auto rawData = base64::to_base64(json.dump());
     return this->sendData(rawData.c_str(), rawData.size());
 }
 
 bool Client::sendData(const void* buffer, const size_t size) const 
 {
-    if (!m_ssl || size == 0) return false;
+    if (size == 0) return false;
 
     const size_t total_size = sizeof(uint32_t) + size;
     std::vector<uint8_t> send_buffer(total_size);
@@ -153,20 +268,29 @@ bool Client::sendData(const void* buffer, const size_t size) const
     memcpy(send_buffer.data(), &sz, sizeof(sz));
     memcpy(send_buffer.data() + sizeof(uint32_t), buffer, size);
 
-    size_t total_sent = 0;
-    while (total_sent < total_size) {
-        int ret = SSL_write(m_ssl, send_buffer.data() + total_sent, static_cast<int>(total_size - total_sent));
-        if (ret <= 0) {
-            int err = SSL_get_error(m_ssl, ret);
-            if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE)
-                continue;
-            const_cast<Client*>(this)->disconnect();
-            return false;
+    uint64_t generation;
+    {
+        std::lock_guard lock(m_conn_mtx);
+        if (!m_conn) return false;
+
+        size_t total_sent = 0;
+        while (total_sent < total_size) {
+            int ret = SSL_write(m_conn->ssl, send_buffer.data() + total_sent, static_cast<int>(total_size - total_sent));
+            if (ret <= 0) {
+                int err = SSL_get_error(m_conn->ssl, ret);
+                if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE)
+                    continue;
+                break;
+            }
+            total_sent += ret;
         }
-        total_sent += ret;
+        if (total_sent == total_size) return true;
+        generation = m_conn->generation;
     }
 
-    return true;
+    // Outside the lock, the teardown takes it again
+    const_cast<Client*>(this)->connectionLost(generation);
+    return false;
 }
 //{ 
 //    if (!m_ssl) return false;
@@ -181,9 +305,9 @@ bool Client::sendData(const void* buffer, const size_t size) const
 //    return bytes_sent == static_cast<int>(send_buffer.size());
 //}
 
-void Client::handleSSLError(int result)
+void Client::handleSSLError(Connection const& conn, int result)
 {
-    int err = SSL_get_error(m_ssl, result);
+    int err = SSL_get_error(conn.ssl, result);
     switch (err) {
     case SSL_ERROR_ZERO_RETURN:
     case SSL_ERROR_SYSCALL:
@@ -191,7 +315,7 @@ void Client::handleSSLError(int result)
     {
         auto text = ERR_reason_error_string(ERR_get_error());
         std::println(stderr, "SSL connection error {}: {}", err, text == nullptr ? "" : text);
-        disconnect();
+        this->connectionLost(conn.generation);
         break;
     }
     case SSL_ERROR_WANT_READ:
@@ -199,29 +323,28 @@ void Client::handleSSLError(int result)
         break;
     default:
         std::println(stderr, "Unknown SSL error: {}", err);
-        disconnect();
+        this->connectionLost(conn.generation);
         break;
     }
 }
 
-std::vector<uint8_t> Client::receiveData()
+std::vector<uint8_t> Client::receiveData(Connection const& conn)
 {
     std::vector<uint8_t> buffer;
-    if (!m_ssl || m_status != SocketStatus::connected) return {};
 
     uint32_t size = 0;
-    int bytes = SSL_read(m_ssl, reinterpret_cast<char*>(&size), sizeof(size));
+    int bytes = SSL_read(conn.ssl, reinterpret_cast<char*>(&size), sizeof(size));
     if (bytes <= 0) {
-        handleSSLError(bytes);
+        handleSSLError(conn, bytes);
         return {};
     }
 
     if (size == 0) return {};
     buffer.resize(size);
 
-    bytes = SSL_read(m_ssl, buffer.data(), static_cast<int>(size));
+    bytes = SSL_read(conn.ssl, buffer.data(), static_cast<int>(size));
     if (bytes <= 0) {
-        handleSSLError(bytes);
+        handleSSLError(conn, bytes);
         return {};
     }
 
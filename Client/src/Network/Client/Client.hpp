@@ -1,30 +1,60 @@
 #pragma once
 #include "../../Utils/ThreadPool/ThreadPool.hpp"
 #include "../Core/SocketStatus.hpp"
+#include "../Core/WireFormat.hpp"
 
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 #include <WinSock2.h>
 #include <vector>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
 
 class Client
 {
 private:
-	SOCKET						m_socket;
+	// One TLS connection. Readers and writers hold it by shared_ptr, so a
+	// teardown never frees the SSL under a blocked SSL_read: it only shuts the
+	// socket down to wake the reader, the last holder closes and frees it
+	struct Connection {
+		SOCKET		socket;
+		SSL*		ssl;
+		uint64_t	generation;		// errors of an older one are stale
+
+		Connection(SOCKET socket, SSL* ssl, uint64_t generation) : socket(socket), ssl(ssl), generation(generation) {}
+		~Connection() {
+			SSL_free(ssl);
+			closesocket(socket);
+		}
+	};
+
 	WSAData						m_wData;
-	SOCKADDR_IN					m_address;
-	SocketStatus				m_status;
+	std::atomic<SocketStatus>	m_status;
 	ThreadPool					m_thread_pool;
 	class SDLContainer*			m_container;
 	SSL_CTX*					m_ctx;
-	SSL*						m_ssl;
+	std::atomic<WireFormat>		m_wire_format;
+	// Guards m_conn, its teardown and replacement. Sends hold it for a whole
+	// frame, pages sending from several threads never interleave and never
+	// write to a connection being torn down
+	mutable std::mutex			m_conn_mtx;
+	std::shared_ptr<Connection>	m_conn;
+	uint64_t					m_generation;
+	uint32_t					m_host;
+	uint16_t					m_port;
+	std::mutex					m_session_mtx;
+	std::string					m_session_token;
+	std::atomic<uint64_t>		m_resume_request;
+	// Claimed by the one job reconnecting, see connectionLost()
+	std::atomic_bool			m_resuming;
+	std::atomic_bool			m_closed;		// disconnected on purpose, set under m_conn_mtx
 
 public:
 	Client(class SDLContainer* con);
 	~Client() { 
-		if (m_status == SocketStatus::connected)
-			this->disconnect(false);
+		this->disconnect(false);
 		m_thread_pool.stop();
 		WSACleanup(); 
 	}
@@ -34,13 +64,17 @@ public:
 	SocketStatus connectTo(std::string const& host, uint16_t port) noexcept;
 	SocketStatus disconnect(bool forced = true) noexcept;
 
-	void dataReceivingLoop();
 	bool sendData(class Packet const& packet) const;
+	// Token from the last login, used to log back in after the connection dropped
+	void setSessionToken(std::string token);
 private:
+	void dataReceivingLoop(std::shared_ptr<Connection> const& conn);
+	bool teardown(uint64_t generation) noexcept;
+	void connectionLost(uint64_t generation) noexcept;
+	void resumeSession();
 	bool sendData(const void* buffer, const size_t size) const;
-	void handleSSLError(int result);
-	std::vector<uint8_t> receiveData();
+	void handleSSLError(Connection const& conn, int result);
+	std::vector<uint8_t> receiveData(Connection const& conn);
 
 
 };
-
@@ -0,0 +1,121 @@
+#pragma once
+#include <stdint.h>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../../Utils/Json.hpp"
+#include "../../Utils/BinaryStream.hpp"
+
+// Row filter of a GetData request, all filters of a query are ANDed
+enum class FilterOp : uint8_t {
+	eq,
+	ne,
+	lt,
+	le,
+	gt,
+	ge,
+	// Text match, value is taken literally (no LIKE wildcards)
+	contains,
+	prefix,
+};
+
+struct DataFilter {
+	std::string		column;
+	FilterOp		op = FilterOp::eq;
+	nlohmann::json	value;
+};
+
+// Paging, filtering and ordering of a GetData request, executed by SQLite.
+// Rows are always ordered by (order_by, id), so the id of the last row seen
+// together with its order_by value is a stable keyset cursor for the next
+// page. An empty query reads the whole table, as older clients expect.
+struct DataQuery {
+	static constexpr uint32_t max_limit = 1000;
+
+	uint32_t				limit = 0;			// 0 - no limit
+	uint64_t				offset = 0;
+	std::string				order_by;			// empty - by id
+	bool					descending = false;
+	std::optional<int64_t>	after_id;
+	nlohmann::json			after_value;		// order_by value of the after_id row
+	std::vector<DataFilter>	filters;
+
+	bool empty() const {
+		return limit == 0 && offset == 0 && order_by.empty() && !descending && !after_id && filters.empty();
+	}
+
+	void write(BinaryWriter& out) const {
+		out.writeVarint(limit);
+		out.writeVarint(offset);
+		out.writeString(order_by);
+		out.writeU8(descending);
+		out.writeU8(after_id.has_value());
+		if (after_id) {
+			out.writeSVarint(*after_id);
+			out.writeJson(after_value);
+		}
+		out.writeVarint(filters.size());
+		for (auto const& filter : filters) {
+			out.writeString(filter.column);
+			out.writeU8(static_cast<uint8_t>(filter.op));
+			out.writeJson(filter.value);
+		}
+	}
+
+	void read(BinaryReader& in) {
+		limit = static_cast<uint32_t>(in.readVarint());
+		offset = in.readVarint();
+		order_by = in.readString();
+		descending = in.readU8() != 0;
+		after_id.reset();
+		if (in.readU8()) {
+			after_id = in.readSVarint();
+			after_value = in.readJson();
+		}
+		filters.clear();
+		for (uint64_t count = in.readVarint(); count != 0; --count) {
+			DataFilter filter;
+			filter.column = in.readString();
+			filter.op = static_cast<FilterOp>(in.readU8());
+			filter.value = in.readJson();
+			filters.push_back(std::move(filter));
+		}
+	}
+};
+
+inline void to_json(nlohmann::json& json, DataFilter const& filter) {
+	json["column"] = filter.column;
+	json["op"] = filter.op;
+	json["value"] = filter.value;
+}
+
+inline void from_json(nlohmann::json const& json, DataFilter& filter) {
+	filter.column = json.at("column").get<std::string>();
+	filter.op = json.at("op").get<FilterOp>();
+	filter.value = json.value("value", nlohmann::json());
+}
+
+inline void to_json(nlohmann::json& json, DataQuery const& query) {
+	json["limit"] = query.limit;
+	json["offset"] = query.offset;
+	json["order_by"] = query.order_by;
+	json["desc"] = query.descending;
+	if (query.after_id)
+		json["after"] = { { "id", *query.after_id }, { "value", query.after_value } };
+	json["filters"] = query.filters;
+}
+
+inline void from_json(nlohmann::json const& json, DataQuery& query) {
+	query.limit = json.value("limit", 0u);
+	query.offset = json.value("offset", uint64_t(0));
+	query.order_by = json.value("order_by", std::string());
+	query.descending = json.value("desc", false);
+	query.after_id.reset();
+	if (json.contains("after")) {
+		auto const& after = json.at("after");
+		query.after_id = after.at("id").get<int64_t>();
+		query.after_value = after.value("value", nlohmann::json());
+	}
+	query.filters = json.value("filters", std::vector<DataFilter>());
+}
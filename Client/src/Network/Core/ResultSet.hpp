@@ -0,0 +1,85 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+
+#include "../../Utils/Json.hpp"
+
+// Read only view over a GetData result. Understands the columnar layout
+// {"columns": [...], "rows": [[...], ...]} as well as the older array of row
+// objects, rows are looked up by column name either way.
+class ResultSet
+{
+private:
+	nlohmann::json const*					m_rows;
+	std::unordered_map<std::string, size_t>	m_columns;
+	bool									m_columnar;
+	bool									m_hasMore = false;
+
+	static nlohmann::json const& null_value() {
+		static const nlohmann::json value;
+		return value;
+	}
+
+public:
+	class Row
+	{
+	private:
+		ResultSet const*		m_set;
+		nlohmann::json const*	m_row;
+
+	public:
+		Row(ResultSet const* set, nlohmann::json const* row) : m_set(set), m_row(row) { }
+
+		bool contains(std::string const& column) const {
+			if (!m_set->m_columnar) return m_row->contains(column);
+			auto it = m_set->m_columns.find(column);
+			return it != m_set->m_columns.end() && it->second < m_row->size();
+		}
+
+		nlohmann::json const& operator[](std::string const& column) const {
+			if (!contains(column)) return null_value();
+			if (!m_set->m_columnar) return m_row->at(column);
+			return m_row->at(m_set->m_columns.at(column));
+		}
+	};
+
+	class Iterator
+	{
+	private:
+		ResultSet const*					m_set;
+		nlohmann::json::const_iterator		m_it;
+
+	public:
+		Iterator(ResultSet const* set, nlohmann::json::const_iterator it) : m_set(set), m_it(it) { }
+
+		Row operator*() const { return Row(m_set, &*m_it); }
+		Iterator& operator++() { ++m_it; return *this; }
+		bool operator!=(Iterator const& other) const { return m_it != other.m_it; }
+	};
+
+	explicit ResultSet(nlohmann::json const& data) : m_rows(&data), m_columnar(false) {
+		if (!data.is_object() || !data.contains("columns") || !data.contains("rows")) {
+			if (!data.is_array()) m_rows = &empty_rows();
+			return;
+		}
+
+		m_columnar = true;
+		m_hasMore = data.value("has_more", false);
+		m_rows = &data.at("rows");
+		auto const& columns = data.at("columns");
+		for (size_t i = 0; i < columns.size(); ++i)
+			m_columns.emplace(columns[i].get<std::string>(), i);
+	}
+
+	size_t size() const { return m_rows->size(); }
+	// Paged queries only, the server holds rows past this page
+	bool hasMore() const { return m_hasMore; }
+	Iterator begin() const { return Iterator(this, m_rows->cbegin()); }
+	Iterator end() const { return Iterator(this, m_rows->cend()); }
+
+private:
+	static nlohmann::json const& empty_rows() {
+		static const nlohmann::json value = nlohmann::json::array();
+		return value;
+	}
+};
@@ -11,5 +11,11 @@ enum class PacketID : uint8_t
 	DeleteData,
 	EditData,
 	AddData,
+	ResumeSession,
+	FreeRooms,
+	RoomAvailability,
+	Subscribe,
+	RowChange,
+	Batch,
 	Unknown = 0xFF
 };
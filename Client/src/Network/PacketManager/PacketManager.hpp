@@ -8,6 +8,12 @@
 #include "Packets/DeleteDataPacket/DeleteDataPacket.hpp"
 #include "Packets/EditDataPacket/EditDataPacket.hpp"
 #include "Packets/AddDataPacket/AddDataPacket.hpp"
+#include "Packets/ResumeSessionPacket/ResumeSessionPacket.hpp"
+#include "Packets/FreeRoomsPacket/FreeRoomsPacket.hpp"
+#include "Packets/RoomAvailabilityPacket/RoomAvailabilityPacket.hpp"
+#include "Packets/SubscribePacket/SubscribePacket.hpp"
+#include "Packets/RowChangePacket/RowChangePacket.hpp"
+#include "Packets/BatchPacket/BatchPacket.hpp"
 
 class PacketManager
 {
@@ -39,6 +45,24 @@ public:
 		case PacketID::AddData:
 			return std::make_unique<AddDataPacket>();
 			break;
+		case PacketID::ResumeSession:
+			return std::make_unique<ResumeSessionPacket>();
+			break;
+		case PacketID::FreeRooms:
+			return std::make_unique<FreeRoomsPacket>();
+			break;
+		case PacketID::RoomAvailability:
+			return std::make_unique<RoomAvailabilityPacket>();
+			break;
+		case PacketID::Subscribe:
+			return std::make_unique<SubscribePacket>();
+			break;
+		case PacketID::RowChange:
+			return std::make_unique<RowChangePacket>();
+			break;
+		case PacketID::Batch:
+			return std::make_unique<BatchPacket>();
+			break;
 		default:
 			return std::make_unique<Packet>();
 			break;
@@ -71,6 +95,24 @@ public:
 		case PacketID::AddData:
 			return std::make_unique<AddDataPacket>(data);
 			break;
+		case PacketID::ResumeSession:
+			return std::make_unique<ResumeSessionPacket>(data);
+			break;
+		case PacketID::FreeRooms:
+			return std::make_unique<FreeRoomsPacket>(data);
+			break;
+		case PacketID::RoomAvailability:
+			return std::make_unique<RoomAvailabilityPacket>(data);
+			break;
+		case PacketID::Subscribe:
+			return std::make_unique<SubscribePacket>(data);
+			break;
+		case PacketID::RowChange:
+			return std::make_unique<RowChangePacket>(data);
+			break;
+		case PacketID::Batch:
+			return std::make_unique<BatchPacket>(data);
+			break;
 		default:
 			return std::make_unique<Packet>();
 			break;
@@ -80,5 +122,14 @@ public:
 		PacketID id = data["type"];
 		return PacketManager::CreatePacket(id, data);
 	}
+	static std::unique_ptr<Packet> CreatePacket(BinaryReader& in) {
+		if (in.readU8() != BinaryStream::magic)
+			return std::make_unique<Packet>();
+
+		auto packet = PacketManager::CreatePacket(static_cast<PacketID>(in.readU8()));
+		if (packet->getID() != PacketID::Unknown)
+			packet->parseBinary(in);
+		return packet;
+	}
 };
 
@@ -39,4 +39,14 @@ nlohmann::json AddDataPacket::toJSON() const  {
 	json["table"] = m_table;
 	json["data"] = m_data.dump();
 	return json;
-}
\ No newline at end of file
+}
+
+void AddDataPacket::writeFields(BinaryWriter& out) const {
+	out.writeVarint(static_cast<uint64_t>(m_table));
+	out.writeJson(m_data);
+}
+
+void AddDataPacket::readFields(BinaryReader& in) {
+	m_table = static_cast<TableID>(in.readVarint());
+	m_data = in.readJson();
+}
@@ -0,0 +1,87 @@
+#include "BatchPacket.hpp"
+
+#include <stdexcept>
+
+BatchPacket::BatchPacket() = default;
+
+BatchPacket::BatchPacket(nlohmann::json& data) {
+	this->parse(data);
+}
+
+BatchPacket& BatchPacket::add(Operation operation) {
+	m_operations.push_back(std::move(operation));
+	return *this;
+}
+
+size_t BatchPacket::size() const {
+	return m_operations.size();
+}
+
+void BatchPacket::handlePacket() {
+
+}
+
+PacketID BatchPacket::getID() const {
+	return PacketID::Batch;
+}
+
+std::string BatchPacket::getName() const {
+	return "BatchPacket";
+}
+
+void BatchPacket::parse(nlohmann::json& data) {
+	m_requestID = data["request_id"];
+	m_operations.clear();
+	for (auto& json : data["operations"]) {
+		switch (json.value("type", PacketID::Unknown))
+		{
+		case PacketID::AddData:		m_operations.emplace_back(AddDataPacket(json)); break;
+		case PacketID::EditData:	m_operations.emplace_back(EditDataPacket(json)); break;
+		case PacketID::DeleteData:	m_operations.emplace_back(DeleteDataPacket(json)); break;
+		default:					break;
+		}
+	}
+}
+
+std::string BatchPacket::toString() const {
+	return this->toJSON().dump();
+}
+
+nlohmann::json BatchPacket::toJSON() const {
+	nlohmann::json json;
+	json["type"] = this->getID();
+	json["request_id"] = m_requestID;
+	auto& operations = json["operations"] = nlohmann::json::array();
+	for (auto const& operation : m_operations) {
+		std::visit([&operations](auto const& packet) { operations.push_back(packet.toJSON()); }, operation);
+	}
+	return json;
+}
+
+void BatchPacket::writeFields(BinaryWriter& out) const {
+	out.writeVarint(m_operations.size());
+	for (auto const& operation : m_operations) {
+		std::visit([&out](auto const& packet) {
+			out.writeU8(static_cast<uint8_t>(packet.getID()));
+			packet.writeFields(out);
+		}, operation);
+	}
+}
+
+void BatchPacket::readFields(BinaryReader& in) {
+	const auto count = in.readVarint();
+	if (count > max_operations) throw std::length_error("Too many batch operations");
+
+	m_operations.clear();
+	m_operations.reserve(count);
+	for (uint64_t i = 0; i < count; ++i) {
+		switch (static_cast<PacketID>(in.readU8()))
+		{
+		case PacketID::AddData:		m_operations.emplace_back(AddDataPacket()); break;
+		case PacketID::EditData:	m_operations.emplace_back(EditDataPacket()); break;
+		case PacketID::DeleteData:	m_operations.emplace_back(DeleteDataPacket()); break;
+		default:					throw std::invalid_argument("Unsupported batch operation");
+		}
+		std::visit([&in](auto& packet) { packet.readFields(in); }, m_operations.back());
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "../Packet.hpp"
+#include "../AddDataPacket/AddDataPacket.hpp"
+#include "../EditDataPacket/EditDataPacket.hpp"
+#include "../DeleteDataPacket/DeleteDataPacket.hpp"
+
+#include <variant>
+#include <vector>
+
+// Many AddData, EditData and DeleteData operations in one request, the
+// server runs them in one transaction and commits all or none. A success
+// carries {"ids": [...]}, the row each operation wrote in order, a failure
+// {"failed": index} of the operation that was refused.
+class BatchPacket : public Packet
+{
+public:
+	using Operation = std::variant<AddDataPacket, EditDataPacket, DeleteDataPacket>;
+
+	// The server refuses larger batches
+	static constexpr size_t max_operations = 1000;
+
+private:
+	std::vector<Operation>	m_operations;
+public:
+	BatchPacket();
+	BatchPacket(nlohmann::json& data);
+
+	BatchPacket& add(Operation operation);
+	size_t size() const;
+
+	void handlePacket() override;
+	PacketID getID() const override;
+	std::string getName() const override;
+	void parse(nlohmann::json& data) override;
+	std::string toString() const override;
+	nlohmann::json toJSON() const override;
+	void writeFields(BinaryWriter& out) const override;
+	void readFields(BinaryReader& in) override;
+};
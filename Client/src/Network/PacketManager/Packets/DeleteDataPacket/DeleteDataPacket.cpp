@@ -40,3 +40,13 @@ nlohmann::json DeleteDataPacket::toJSON() const {
 	json["record_id"] = m_recordID;
 	return json;
 }
+
+void DeleteDataPacket::writeFields(BinaryWriter& out) const {
+	out.writeVarint(static_cast<uint64_t>(m_tableID));
+	out.writeSVarint(m_recordID);
+}
+
+void DeleteDataPacket::readFields(BinaryReader& in) {
+	m_tableID = static_cast<TableID>(in.readVarint());
+	m_recordID = in.readSVarint();
+}
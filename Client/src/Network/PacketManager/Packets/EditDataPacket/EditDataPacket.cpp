@@ -48,3 +48,15 @@ nlohmann::json EditDataPacket::toJSON() const {
 	json["new_data"] = m_newData.dump();
 	return json;
 }
+
+void EditDataPacket::writeFields(BinaryWriter& out) const {
+	out.writeVarint(static_cast<uint64_t>(m_tableID));
+	out.writeSVarint(m_recordID);
+	out.writeJson(m_newData);
+}
+
+void EditDataPacket::readFields(BinaryReader& in) {
+	m_tableID = static_cast<TableID>(in.readVarint());
+	m_recordID = in.readSVarint();
+	m_newData = in.readJson();
+}
@@ -0,0 +1,57 @@
+#include "FreeRoomsPacket.hpp"
+
+FreeRoomsPacket::FreeRoomsPacket() = default;
+
+FreeRoomsPacket::FreeRoomsPacket(std::string checkIn, std::string checkOut, uint32_t capacity)
+	: m_checkIn(std::move(checkIn)), m_checkOut(std::move(checkOut)), m_capacity(capacity) {
+
+}
+
+FreeRoomsPacket::FreeRoomsPacket(nlohmann::json& data) {
+	this->parse(data);
+}
+
+void FreeRoomsPacket::handlePacket() {
+
+}
+
+PacketID FreeRoomsPacket::getID() const {
+	return PacketID::FreeRooms;
+}
+
+std::string FreeRoomsPacket::getName() const {
+	return "FreeRoomsPacket";
+}
+
+void FreeRoomsPacket::parse(nlohmann::json& data) {
+	m_checkIn = data["check_in"].get<std::string>();
+	m_checkOut = data["check_out"].get<std::string>();
+	m_capacity = data.value("capacity", 0u);
+	m_requestID = data["request_id"];
+}
+
+std::string FreeRoomsPacket::toString() const {
+	return this->toJSON().dump();
+}
+
+nlohmann::json FreeRoomsPacket::toJSON() const {
+	nlohmann::json json;
+	json["type"] = this->getID();
+	json["request_id"] = m_requestID;
+	json["check_in"] = m_checkIn;
+	json["check_out"] = m_checkOut;
+	json["capacity"] = m_capacity;
+	return json;
+}
+
+void FreeRoomsPacket::writeFields(BinaryWriter& out) const {
+	out.writeString(m_checkIn);
+	out.writeString(m_checkOut);
+	out.writeVarint(m_capacity);
+}
+
+void FreeRoomsPacket::readFields(BinaryReader& in) {
+	m_checkIn = in.readString();
+	m_checkOut = in.readString();
+	m_capacity = static_cast<uint32_t>(in.readVarint());
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "../Packet.hpp"
+
+// Asks for the rooms free over [checkIn, checkOut) that hold at least
+// capacity guests. The response carries them in the columnar layout, read
+// it with ResultSet.
+class FreeRoomsPacket : public Packet
+{
+private:
+	std::string	m_checkIn;
+	std::string	m_checkOut;
+	uint32_t	m_capacity = 0;
+public:
+	FreeRoomsPacket();
+	FreeRoomsPacket(std::string checkIn, std::string checkOut, uint32_t capacity = 0);
+	FreeRoomsPacket(nlohmann::json& data);
+
+	void handlePacket() override;
+	PacketID getID() const override;
+	std::string getName() const override;
+	void parse(nlohmann::json& data) override;
+	std::string toString() const override;
+	nlohmann::json toJSON() const override;
+	void writeFields(BinaryWriter& out) const override;
+	void readFields(BinaryReader& in) override;
+};
@@ -10,6 +10,29 @@ GetDataPacket::GetDataPacket(TableID table) : m_table(table) {
 
 }
 
+GetDataPacket& GetDataPacket::setPage(uint32_t limit, uint64_t offset) {
+	m_query.limit = limit;
+	m_query.offset = offset;
+	return *this;
+}
+
+GetDataPacket& GetDataPacket::setCursor(int64_t afterId, nlohmann::json afterValue) {
+	m_query.after_id = afterId;
+	m_query.after_value = std::move(afterValue);
+	return *this;
+}
+
+GetDataPacket& GetDataPacket::setOrder(std::string column, bool descending) {
+	m_query.order_by = std::move(column);
+	m_query.descending = descending;
+	return *this;
+}
+
+GetDataPacket& GetDataPacket::addFilter(std::string column, FilterOp op, nlohmann::json value) {
+	m_query.filters.push_back(DataFilter{ std::move(column), op, std::move(value) });
+	return *this;
+}
+
 void GetDataPacket::handlePacket() {
 
 }
@@ -25,6 +48,7 @@ std::string GetDataPacket::getName() const {
 void GetDataPacket::parse(nlohmann::json& data) {
 	m_table = data["table"];
 	m_requestID = data["request_id"];
+	m_query = data.contains("query") ? data["query"].get<DataQuery>() : DataQuery();
 }
 
 std::string GetDataPacket::toString() const {
@@ -36,5 +60,22 @@ nlohmann::json GetDataPacket::toJSON() const {
 	json["type"] = this->getID();
 	json["request_id"] = m_requestID;
 	json["table"] = m_table;
+	// Results come back as {"columns", "rows"}, read them through ResultSet
+	json["columnar"] = true;
+	if (!m_query.empty()) json["query"] = m_query;
 	return json;
 }
+
+void GetDataPacket::writeFields(BinaryWriter& out) const {
+	out.writeVarint(static_cast<uint64_t>(m_table));
+	out.writeU8(1);
+	out.writeU8(!m_query.empty());
+	if (!m_query.empty()) m_query.write(out);
+}
+
+void GetDataPacket::readFields(BinaryReader& in) {
+	m_table = static_cast<TableID>(in.readVarint());
+	in.readU8();
+	m_query = DataQuery();
+	if (!in.atEnd() && in.readU8()) m_query.read(in);
+}
@@ -1,21 +1,31 @@
 #pragma once
 #include "../Packet.hpp"
 #include "../../../Core/DatabaseSchema.hpp"
+#include "../../../Core/DataQuery.hpp"
 
 class GetDataPacket : public Packet
 {
 private:
-	TableID m_table;
+	TableID		m_table;
+	DataQuery	m_query;
 public:
 	GetDataPacket();
 	GetDataPacket(TableID table);
 	GetDataPacket(nlohmann::json& data);
 
+	// Query options, the server reads the whole table when none are set
+	GetDataPacket& setPage(uint32_t limit, uint64_t offset = 0);
+	GetDataPacket& setCursor(int64_t afterId, nlohmann::json afterValue);
+	GetDataPacket& setOrder(std::string column, bool descending = false);
+	GetDataPacket& addFilter(std::string column, FilterOp op, nlohmann::json value);
+
 	void handlePacket() override;
 	PacketID getID() const override;
 	std::string getName() const override;
 	void parse(nlohmann::json& data) override;
 	std::string toString() const override ;
 	nlohmann::json toJSON() const override;
+	void writeFields(BinaryWriter& out) const override;
+	void readFields(BinaryReader& in) override;
 };
 
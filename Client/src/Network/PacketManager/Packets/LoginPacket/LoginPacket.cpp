@@ -39,4 +39,14 @@ nlohmann::json LoginPacket::toJSON() const {
 	json["login"] = m_login;
 	json["password"] = m_password;
 	return json;
-}
\ No newline at end of file
+}
+
+void LoginPacket::writeFields(BinaryWriter& out) const {
+	out.writeString(m_login);
+	out.writeString(m_password);
+}
+
+void LoginPacket::readFields(BinaryReader& in) {
+	m_login = in.readString();
+	m_password = in.readString();
+}
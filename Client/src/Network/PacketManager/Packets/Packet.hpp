@@ -1,6 +1,7 @@
 #pragma once
 #include "../PacketID.hpp"
 #include "../../../Utils/Json.hpp"
+#include "../../../Utils/BinaryStream.hpp"
 #include <string>
 #include <chrono>
 
@@ -28,6 +29,24 @@ public:
 		return json;
 	}
 
+	// Binary encoding, see BinaryStream.hpp. Packets only (de)serialize their own fields
+	virtual void writeFields(BinaryWriter& out) const { }
+	virtual void readFields(BinaryReader& in) { }
+
+	std::string toBinary() const {
+		BinaryWriter out;
+		out.writeU8(BinaryStream::magic);
+		out.writeU8(static_cast<uint8_t>(this->getID()));
+		out.writeVarint(m_requestID);
+		this->writeFields(out);
+		return out.release();
+	}
+
+	void parseBinary(BinaryReader& in) {
+		m_requestID = in.readVarint();
+		this->readFields(in);
+	}
+
 	uint64_t getRequestID() const { return m_requestID; }
 };
 
@@ -47,4 +47,20 @@ nlohmann::json RegisterPacket::toJSON() const {
 	json["surname"] = m_surname;
 	json["phone_number"] = m_phoneNumber;
 	return json;
-}
\ No newline at end of file
+}
+
+void RegisterPacket::writeFields(BinaryWriter& out) const {
+	out.writeString(m_login);
+	out.writeString(m_password);
+	out.writeString(m_name);
+	out.writeString(m_surname);
+	out.writeString(m_phoneNumber);
+}
+
+void RegisterPacket::readFields(BinaryReader& in) {
+	m_login = in.readString();
+	m_password = in.readString();
+	m_name = in.readString();
+	m_surname = in.readString();
+	m_phoneNumber = in.readString();
+}
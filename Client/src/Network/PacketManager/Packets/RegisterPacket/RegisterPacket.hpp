@@ -22,5 +22,7 @@ public:
 	void parse(nlohmann::json& data) override;
 	std::string toString() const override;
 	nlohmann::json toJSON() const override;
+	void writeFields(BinaryWriter& out) const override;
+	void readFields(BinaryReader& in) override;
 };
 
@@ -18,6 +18,15 @@ void ResponsePacket::parse(nlohmann::json& data)  {
 	m_errorCode = data["error_code"];
 	m_errorMessage = data["error_message"];
 	m_requestID = data["request_id"];
+	m_sequence = data.value("sequence", uint64_t(0));
+
+	// Newer servers nest the payload directly, older ones send it as a JSON string
+	auto it = data.find("additional_data");
+	if (it != data.end() && !it->is_string()) {
+		m_additionalData = std::move(*it);
+		return;
+	}
+
 	try {
 		m_additionalData = nlohmann::json::parse(data.value("additional_data", "{}"));
 	}
@@ -37,6 +46,24 @@ nlohmann::json ResponsePacket::toJSON() const  {
 	json["error_code"] = m_errorCode;
 	json["error_message"] = m_errorMessage;
 	json["additional_data"] = m_additionalData.dump();
+	if (m_sequence) json["sequence"] = m_sequence;
 	return json;
 }
 
+void ResponsePacket::writeFields(BinaryWriter& out) const {
+	out.writeVarint(static_cast<uint64_t>(m_errorCode));
+	out.writeString(m_errorMessage);
+	out.writeU8(static_cast<uint8_t>(DataEncoding::msgpack));
+	out.writeJson(m_additionalData);
+	if (m_sequence) out.writeVarint(m_sequence);
+}
+
+void ResponsePacket::readFields(BinaryReader& in) {
+	m_errorCode = static_cast<ResponseID>(in.readVarint());
+	m_errorMessage = in.readString();
+	if (static_cast<DataEncoding>(in.readU8()) == DataEncoding::json_text)
+		m_additionalData = nlohmann::json::parse(in.readStringView());
+	else
+		m_additionalData = in.readJson();
+	m_sequence = in.atEnd() ? 0 : in.readVarint();
+}
@@ -21,10 +21,18 @@ enum class ResponseID
 
 class ResponsePacket : public Packet
 {
+	// How additional_data is stored in the binary encoding
+	enum class DataEncoding : uint8_t {
+		msgpack = 0,
+		json_text = 1,
+	};
+
 private:
 	ResponseID		m_errorCode;
 	std::string		m_errorMessage;
 	nlohmann::json	m_additionalData;
+	// Commit sequence a GetData snapshot was read at, 0 for any other answer
+	uint64_t		m_sequence = 0;
 public:
 	ResponsePacket();
 	ResponsePacket(nlohmann::json& data);
@@ -34,15 +42,19 @@ public:
 	virtual void parse(nlohmann::json& data) override;
 	virtual std::string toString() const override;
 	virtual nlohmann::json toJSON() const override;
+	virtual void writeFields(BinaryWriter& out) const override;
+	virtual void readFields(BinaryReader& in) override;
 
 public:
 	ResponseID	getErrorCode() const { return m_errorCode; }
 	std::string const& getErrorMessage() const { return m_errorMessage; }
 	nlohmann::json const& getAdditionalData() const { return m_additionalData; }
+	uint64_t getSequence() const { return m_sequence; }
 
 	__declspec(property(get = getErrorCode))		ResponseID		errorCode;
 	__declspec(property(get = getErrorMessage))		std::string		errorMessage;
 	__declspec(property(get = getAdditionalData))	nlohmann::json	additionalData;
+	__declspec(property(get = getSequence))			uint64_t		sequence;
 
 };
 
@@ -0,0 +1,48 @@
+#include "ResumeSessionPacket.hpp"
+
+ResumeSessionPacket::ResumeSessionPacket() = default;
+
+ResumeSessionPacket::ResumeSessionPacket(std::string token) : m_token(std::move(token)) {
+
+}
+
+ResumeSessionPacket::ResumeSessionPacket(nlohmann::json& data) {
+	this->parse(data);
+}
+
+void ResumeSessionPacket::handlePacket() {
+
+}
+
+PacketID ResumeSessionPacket::getID() const {
+	return PacketID::ResumeSession;
+}
+
+std::string ResumeSessionPacket::getName() const {
+	return "ResumeSessionPacket";
+}
+
+void ResumeSessionPacket::parse(nlohmann::json& data) {
+	m_token = data["token"].get<std::string>();
+	m_requestID = data["request_id"];
+}
+
+std::string ResumeSessionPacket::toString() const {
+	return this->toJSON().dump();
+}
+
+nlohmann::json ResumeSessionPacket::toJSON() const {
+	nlohmann::json json;
+	json["type"] = this->getID();
+	json["request_id"] = m_requestID;
+	json["token"] = m_token;
+	return json;
+}
+
+void ResumeSessionPacket::writeFields(BinaryWriter& out) const {
+	out.writeString(m_token);
+}
+
+void ResumeSessionPacket::readFields(BinaryReader& in) {
+	m_token = in.readString();
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "../Packet.hpp"
+
+// Logs back in with the session token a LoginPacket response carried
+class ResumeSessionPacket : public Packet
+{
+private:
+	std::string m_token;
+public:
+	ResumeSessionPacket();
+	ResumeSessionPacket(std::string token);
+	ResumeSessionPacket(nlohmann::json& data);
+
+	void handlePacket() override;
+	PacketID getID() const override;
+	std::string getName() const override;
+	void parse(nlohmann::json& data) override;
+	std::string toString() const override;
+	nlohmann::json toJSON() const override;
+	void writeFields(BinaryWriter& out) const override;
+	void readFields(BinaryReader& in) override;
+};
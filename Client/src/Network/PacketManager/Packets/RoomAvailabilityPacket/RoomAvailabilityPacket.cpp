@@ -0,0 +1,61 @@
+#include "RoomAvailabilityPacket.hpp"
+
+RoomAvailabilityPacket::RoomAvailabilityPacket() = default;
+
+RoomAvailabilityPacket::RoomAvailabilityPacket(int64_t roomId, std::string checkIn, std::string checkOut, uint32_t capacity)
+	: m_roomId(roomId), m_checkIn(std::move(checkIn)), m_checkOut(std::move(checkOut)), m_capacity(capacity) {
+
+}
+
+RoomAvailabilityPacket::RoomAvailabilityPacket(nlohmann::json& data) {
+	this->parse(data);
+}
+
+void RoomAvailabilityPacket::handlePacket() {
+
+}
+
+PacketID RoomAvailabilityPacket::getID() const {
+	return PacketID::RoomAvailability;
+}
+
+std::string RoomAvailabilityPacket::getName() const {
+	return "RoomAvailabilityPacket";
+}
+
+void RoomAvailabilityPacket::parse(nlohmann::json& data) {
+	m_roomId = data.value("room_id", int64_t(0));
+	m_checkIn = data["check_in"].get<std::string>();
+	m_checkOut = data["check_out"].get<std::string>();
+	m_capacity = data.value("capacity", 0u);
+	m_requestID = data["request_id"];
+}
+
+std::string RoomAvailabilityPacket::toString() const {
+	return this->toJSON().dump();
+}
+
+nlohmann::json RoomAvailabilityPacket::toJSON() const {
+	nlohmann::json json;
+	json["type"] = this->getID();
+	json["request_id"] = m_requestID;
+	json["room_id"] = m_roomId;
+	json["check_in"] = m_checkIn;
+	json["check_out"] = m_checkOut;
+	json["capacity"] = m_capacity;
+	return json;
+}
+
+void RoomAvailabilityPacket::writeFields(BinaryWriter& out) const {
+	out.writeSVarint(m_roomId);
+	out.writeString(m_checkIn);
+	out.writeString(m_checkOut);
+	out.writeVarint(m_capacity);
+}
+
+void RoomAvailabilityPacket::readFields(BinaryReader& in) {
+	m_roomId = in.readSVarint();
+	m_checkIn = in.readString();
+	m_checkOut = in.readString();
+	m_capacity = static_cast<uint32_t>(in.readVarint());
+}
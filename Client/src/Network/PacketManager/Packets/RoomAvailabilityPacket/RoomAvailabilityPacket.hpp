@@ -0,0 +1,27 @@
+#pragma once
+#include "../Packet.hpp"
+
+// Asks whether a room is free over [checkIn, checkOut), or with room id 0
+// for every free room holding at least capacity guests. The response
+// carries {"room_id", "free"} or {"rooms": [ids]} respectively.
+class RoomAvailabilityPacket : public Packet
+{
+private:
+	int64_t		m_roomId = 0;
+	std::string	m_checkIn;
+	std::string	m_checkOut;
+	uint32_t	m_capacity = 0;
+public:
+	RoomAvailabilityPacket();
+	RoomAvailabilityPacket(int64_t roomId, std::string checkIn, std::string checkOut, uint32_t capacity = 0);
+	RoomAvailabilityPacket(nlohmann::json& data);
+
+	void handlePacket() override;
+	PacketID getID() const override;
+	std::string getName() const override;
+	void parse(nlohmann::json& data) override;
+	std::string toString() const override;
+	nlohmann::json toJSON() const override;
+	void writeFields(BinaryWriter& out) const override;
+	void readFields(BinaryReader& in) override;
+};
@@ -0,0 +1,60 @@
+#include "RowChangePacket.hpp"
+
+RowChangePacket::RowChangePacket() = default;
+
+RowChangePacket::RowChangePacket(nlohmann::json& data) {
+	this->parse(data);
+}
+
+void RowChangePacket::handlePacket() {
+
+}
+
+PacketID RowChangePacket::getID() const {
+	return PacketID::RowChange;
+}
+
+std::string RowChangePacket::getName() const {
+	return "RowChangePacket";
+}
+
+void RowChangePacket::parse(nlohmann::json& data) {
+	m_table = data["table_id"];
+	m_change = data["change"];
+	m_rowID = data["row_id"];
+	m_row = data.value("row", nlohmann::json::object());
+	m_requestID = data["request_id"];
+	m_sequence = data.value("sequence", uint64_t(0));
+}
+
+std::string RowChangePacket::toString() const {
+	return this->toJSON().dump();
+}
+
+nlohmann::json RowChangePacket::toJSON() const {
+	nlohmann::json json;
+	json["type"] = this->getID();
+	json["request_id"] = m_requestID;
+	json["table_id"] = m_table;
+	json["change"] = m_change;
+	json["row_id"] = m_rowID;
+	json["row"] = m_row;
+	json["sequence"] = m_sequence;
+	return json;
+}
+
+void RowChangePacket::writeFields(BinaryWriter& out) const {
+	out.writeVarint(static_cast<uint64_t>(m_table));
+	out.writeU8(static_cast<uint8_t>(m_change));
+	out.writeSVarint(m_rowID);
+	out.writeJson(m_row);
+	out.writeVarint(m_sequence);
+}
+
+void RowChangePacket::readFields(BinaryReader& in) {
+	m_table = static_cast<TableID>(in.readVarint());
+	m_change = static_cast<RowChange>(in.readU8());
+	m_rowID = in.readSVarint();
+	m_row = in.readJson();
+	m_sequence = in.atEnd() ? 0 : in.readVarint();
+}
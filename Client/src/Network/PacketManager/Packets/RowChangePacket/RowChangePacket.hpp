@@ -0,0 +1,48 @@
+#pragma once
+#include "../Packet.hpp"
+#include "../../../Core/DatabaseSchema.hpp"
+
+enum class RowChange : uint8_t {
+	Added,
+	Edited,
+	Deleted,
+};
+
+// Pushed by the server to subscribers of a table after a write, request id
+// is 0 as it answers nothing. row holds the row as it is now and stays empty
+// for a deleted one. sequence numbers the table's changes, GetData answers
+// carry the number their snapshot was taken at.
+class RowChangePacket : public Packet
+{
+private:
+	TableID			m_table;
+	RowChange		m_change;
+	int64_t			m_rowID;
+	nlohmann::json	m_row;
+	uint64_t		m_sequence = 0;
+public:
+	RowChangePacket();
+	RowChangePacket(nlohmann::json& data);
+
+	void handlePacket() override;
+	PacketID getID() const override;
+	std::string getName() const override;
+	void parse(nlohmann::json& data) override;
+	std::string toString() const override;
+	nlohmann::json toJSON() const override;
+	void writeFields(BinaryWriter& out) const override;
+	void readFields(BinaryReader& in) override;
+
+public:
+	TableID getTable() const { return m_table; }
+	RowChange getChange() const { return m_change; }
+	int64_t getRowID() const { return m_rowID; }
+	nlohmann::json const& getRow() const { return m_row; }
+	uint64_t getSequence() const { return m_sequence; }
+
+	__declspec(property(get = getTable))	TableID			table;
+	__declspec(property(get = getChange))	RowChange		change;
+	__declspec(property(get = getRowID))	int64_t			rowID;
+	__declspec(property(get = getRow))		nlohmann::json	row;
+	__declspec(property(get = getSequence))	uint64_t		sequence;
+};
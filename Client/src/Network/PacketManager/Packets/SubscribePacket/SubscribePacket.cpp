@@ -0,0 +1,52 @@
+#include "SubscribePacket.hpp"
+
+SubscribePacket::SubscribePacket() = default;
+
+SubscribePacket::SubscribePacket(TableID table, bool subscribe) : m_table(table), m_subscribe(subscribe) {
+
+}
+
+SubscribePacket::SubscribePacket(nlohmann::json& data) {
+	this->parse(data);
+}
+
+void SubscribePacket::handlePacket() {
+
+}
+
+PacketID SubscribePacket::getID() const {
+	return PacketID::Subscribe;
+}
+
+std::string SubscribePacket::getName() const {
+	return "SubscribePacket";
+}
+
+void SubscribePacket::parse(nlohmann::json& data) {
+	m_table = data["table_id"];
+	m_subscribe = data.value("subscribe", true);
+	m_requestID = data["request_id"];
+}
+
+std::string SubscribePacket::toString() const {
+	return this->toJSON().dump();
+}
+
+nlohmann::json SubscribePacket::toJSON() const {
+	nlohmann::json json;
+	json["type"] = this->getID();
+	json["request_id"] = m_requestID;
+	json["table_id"] = m_table;
+	json["subscribe"] = m_subscribe;
+	return json;
+}
+
+void SubscribePacket::writeFields(BinaryWriter& out) const {
+	out.writeVarint(static_cast<uint64_t>(m_table));
+	out.writeU8(m_subscribe);
+}
+
+void SubscribePacket::readFields(BinaryReader& in) {
+	m_table = static_cast<TableID>(in.readVarint());
+	m_subscribe = in.readU8() != 0;
+}
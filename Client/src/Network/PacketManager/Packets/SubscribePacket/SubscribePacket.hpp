@@ -0,0 +1,24 @@
+#pragma once
+#include "../Packet.hpp"
+#include "../../../Core/DatabaseSchema.hpp"
+
+// Starts or stops the server's RowChangePackets for one table
+class SubscribePacket : public Packet
+{
+private:
+	TableID	m_table;
+	bool	m_subscribe = true;
+public:
+	SubscribePacket();
+	SubscribePacket(TableID table, bool subscribe = true);
+	SubscribePacket(nlohmann::json& data);
+
+	void handlePacket() override;
+	PacketID getID() const override;
+	std::string getName() const override;
+	void parse(nlohmann::json& data) override;
+	std::string toString() const override;
+	nlohmann::json toJSON() const override;
+	void writeFields(BinaryWriter& out) const override;
+	void readFields(BinaryReader& in) override;
+};
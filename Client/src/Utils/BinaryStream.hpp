@@ -0,0 +1,127 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+
+#include "Json.hpp"
+
+// Compact binary packet encoding, used next to base64 wrapped JSON.
+//   magic (1 byte) | PacketID (1 byte) | request_id (varint) | packet fields
+// Unsigned integers are LEB128 varints, signed ones are zigzag encoded first,
+// strings are a varint length followed by the bytes, nested JSON values are
+// length prefixed MessagePack. The magic byte lies outside the base64
+// alphabet, so a receiver tells both encodings apart by the first byte.
+namespace BinaryStream {
+	inline constexpr uint8_t magic = 0xB1;
+
+	// Advertised by the server in JSON responses, a client that sees it may switch to binary
+	inline constexpr uint32_t version = 1;
+}
+
+class BinaryWriter
+{
+private:
+	std::string m_buffer;
+
+public:
+	BinaryWriter() { m_buffer.reserve(64); }
+
+	void writeU8(uint8_t value) { m_buffer.push_back(static_cast<char>(value)); }
+
+	void writeVarint(uint64_t value) {
+		while (value >= 0x80) {
+			m_buffer.push_back(static_cast<char>(value | 0x80));
+			value >>= 7;
+		}
+		m_buffer.push_back(static_cast<char>(value));
+	}
+
+	void writeSVarint(int64_t value) {
+		writeVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+	}
+
+	void writeDouble(double value) {
+		char bytes[sizeof(value)];
+		memcpy(bytes, &value, sizeof(value));
+		m_buffer.append(bytes, sizeof(bytes));
+	}
+
+	void writeString(std::string_view value) {
+		writeVarint(value.size());
+		m_buffer.append(value);
+	}
+
+	void writeJson(nlohmann::json const& value) {
+		std::string packed;
+		nlohmann::json::to_msgpack(value, packed);
+		writeString(packed);
+	}
+
+	std::string const& data() const { return m_buffer; }
+	std::string release() { return std::move(m_buffer); }
+};
+
+class BinaryReader
+{
+private:
+	const uint8_t*	m_data;
+	size_t			m_size;
+	size_t			m_pos;
+
+public:
+	BinaryReader(const void* data, size_t size) : m_data(static_cast<const uint8_t*>(data)), m_size(size), m_pos(0) { }
+
+	uint8_t readU8() {
+		require(1);
+		return m_data[m_pos++];
+	}
+
+	uint64_t readVarint() {
+		uint64_t value = 0;
+		for (unsigned shift = 0; shift < 64; shift += 7) {
+			uint8_t byte = readU8();
+			value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80)) return value;
+		}
+		throw std::runtime_error("Malformed varint");
+	}
+
+	int64_t readSVarint() {
+		uint64_t value = readVarint();
+		return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+	}
+
+	double readDouble() {
+		double value;
+		require(sizeof(value));
+		memcpy(&value, m_data + m_pos, sizeof(value));
+		m_pos += sizeof(value);
+		return value;
+	}
+
+	std::string_view readStringView() {
+		uint64_t size = readVarint();
+		require(size);
+		std::string_view value(reinterpret_cast<const char*>(m_data + m_pos), static_cast<size_t>(size));
+		m_pos += static_cast<size_t>(size);
+		return value;
+	}
+
+	std::string readString() { return std::string(readStringView()); }
+
+	nlohmann::json readJson() {
+		auto packed = readStringView();
+		auto first = reinterpret_cast<const uint8_t*>(packed.data());
+		return nlohmann::json::from_msgpack(first, first + packed.size());
+	}
+
+	bool atEnd() const { return m_pos == m_size; }
+
+private:
+	void require(uint64_t count) const {
+		if (count > m_size - m_pos)
+			throw std::runtime_error("Truncated binary packet");
+	}
+};
@@ -0,0 +1,140 @@
+#pragma once
+#include <stdint.h>
+#include <string_view>
+
+// Field format checks shared by the packet handlers and the client pages.
+// Each one is a hand-written matcher for what used to be a std::regex, it
+// works on a string_view and neither allocates nor builds an automaton per
+// call. The regex each function replaces is quoted above it.
+namespace Validators {
+	namespace detail {
+		constexpr bool isDigit(char ch) { return ch >= '0' && ch <= '9'; }
+		constexpr bool isAlpha(char ch) { return (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z'); }
+
+		constexpr bool allDigits(std::string_view str) {
+			for (char ch : str)
+				if (!isDigit(ch)) return false;
+			return true;
+		}
+
+		constexpr bool inEmailLocal(char ch) {
+			return isAlpha(ch) || isDigit(ch) || ch == '.' || ch == '_' || ch == '%' || ch == '+' || ch == '-';
+		}
+
+		constexpr bool inEmailDomain(char ch) {
+			return isAlpha(ch) || isDigit(ch) || ch == '.' || ch == '-';
+		}
+
+		// Next UTF-8 code point of str starting at pos, 0xFFFFFFFF on a malformed sequence
+		constexpr uint32_t nextCodePoint(std::string_view str, size_t& pos) {
+			const auto lead = static_cast<uint8_t>(str[pos++]);
+			if (lead < 0x80) return lead;
+
+			size_t extra = 0;
+			uint32_t code = 0;
+			if ((lead & 0xE0) == 0xC0)		{ extra = 1; code = lead & 0x1F; }
+			else if ((lead & 0xF0) == 0xE0)	{ extra = 2; code = lead & 0x0F; }
+			else if ((lead & 0xF8) == 0xF0)	{ extra = 3; code = lead & 0x07; }
+			else return 0xFFFFFFFF;
+
+			if (str.size() - pos < extra) return 0xFFFFFFFF;
+			for (; extra != 0; --extra) {
+				const auto next = static_cast<uint8_t>(str[pos++]);
+				if ((next & 0xC0) != 0x80) return 0xFFFFFFFF;
+				code = (code << 6) | (next & 0x3F);
+			}
+			return code;
+		}
+	}
+
+	// ^[A-Za-z0-9._%+-]+@[A-Za-z0-9.-]+\.[A-Za-z]{2,}$
+	constexpr bool isEmail(std::string_view str) {
+		const auto at = str.find('@');
+		if (at == 0 || at == std::string_view::npos) return false;
+		for (char ch : str.substr(0, at))
+			if (!detail::inEmailLocal(ch)) return false;
+
+		// The top level domain holds no dots, so it starts after the last one
+		const auto domain = str.substr(at + 1);
+		const auto dot = domain.rfind('.');
+		if (dot == 0 || dot == std::string_view::npos || domain.size() - dot - 1 < 2) return false;
+		for (char ch : domain.substr(0, dot))
+			if (!detail::inEmailDomain(ch)) return false;
+		for (char ch : domain.substr(dot + 1))
+			if (!detail::isAlpha(ch)) return false;
+		return true;
+	}
+
+	// ^$|^\+?\d{10,15}$
+	constexpr bool isPhone(std::string_view str) {
+		if (str.empty()) return true;
+		if (str.front() == '+') str.remove_prefix(1);
+		return str.size() >= 10 && str.size() <= 15 && detail::allDigits(str);
+	}
+
+	// ^.{8,}$
+	constexpr bool isPassword(std::string_view str) {
+		return str.size() >= 8 && str.find_first_of("\r\n") == std::string_view::npos;
+	}
+
+	// ^[A-Za-zА-Яа-яЁё]{1,20}$, counted in letters rather than UTF-8 bytes
+	constexpr bool isName(std::string_view str) {
+		size_t letters = 0;
+		for (size_t pos = 0; pos < str.size(); ++letters) {
+			const auto code = detail::nextCodePoint(str, pos);
+			const bool latin = code < 0x80 && detail::isAlpha(static_cast<char>(code));
+			const bool cyrillic = (code >= 0x0410 && code <= 0x044F) || code == 0x0401 || code == 0x0451;
+			if (!latin && !cyrillic) return false;
+		}
+		return letters >= 1 && letters <= 20;
+	}
+
+	// ^\d+$
+	constexpr bool isUnsigned(std::string_view str) {
+		return !str.empty() && detail::allDigits(str);
+	}
+
+	// ^\d+$, row ids and other foreign keys
+	constexpr bool isId(std::string_view str) {
+		return isUnsigned(str);
+	}
+
+	// ^\d+[.,]\d+$
+	constexpr bool isPrice(std::string_view str) {
+		const auto sep = str.find_first_of(".,");
+		if (sep == 0 || sep == std::string_view::npos || sep + 1 == str.size()) return false;
+		return detail::allDigits(str.substr(0, sep)) && detail::allDigits(str.substr(sep + 1));
+	}
+
+	// ^[01]$
+	constexpr bool isFlag(std::string_view str) {
+		return str == "0" || str == "1";
+	}
+
+	// ^\d{4}-(0[1-9]|1[0-2])-(0[1-9]|[12]\d|3[01])$
+	constexpr bool isDate(std::string_view str) {
+		if (str.size() != 10 || str[4] != '-' || str[7] != '-') return false;
+		if (!detail::allDigits(str.substr(0, 4)) || !detail::allDigits(str.substr(5, 2)) || !detail::allDigits(str.substr(8, 2)))
+			return false;
+
+		const int month = (str[5] - '0') * 10 + (str[6] - '0');
+		const int day = (str[8] - '0') * 10 + (str[9] - '0');
+		return month >= 1 && month <= 12 && day >= 1 && day <= 31;
+	}
+
+	// ^(подтверждено|отменено|завершено)$
+	constexpr bool isBookingStatus(std::string_view str) {
+		return str == "подтверждено" || str == "отменено" || str == "завершено";
+	}
+
+	// ^(guest|admin)$
+	constexpr bool isUserRole(std::string_view str) {
+		return str == "guest" || str == "admin";
+	}
+
+	static_assert(isEmail("user.name+tag@mail.example.com") && !isEmail("user@localhost") && !isEmail("@mail.com"));
+	static_assert(isPhone("") && isPhone("+79991234567") && !isPhone("+7999"));
+	static_assert(isPrice("1200.50") && isPrice("10,5") && !isPrice("12.") && !isPrice("12"));
+	static_assert(isDate("2024-02-29") && !isDate("2024-13-01") && !isDate("2024-01-00"));
+	static_assert(isName("Иван") && isName("John") && !isName("J0hn") && !isName(""));
+}
@@ -0,0 +1,82 @@
+#include "../src/Utils/Validators.hpp"
+
+#include <chrono>
+#include <print>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Microbenchmark of the Validators matchers against the std::regex checks
+// they replaced: a regex built on every call, as the handlers used to, and
+// one built once for reference. Inputs mix values that pass and fail.
+
+struct Case {
+    std::string_view name;
+    const char* pattern;
+    bool (*matcher)(std::string_view);
+    std::vector<std::string> inputs;
+};
+
+template<typename F>
+static double nsPerCall(size_t calls, F&& body) {
+    const auto start = std::chrono::steady_clock::now();
+    body();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / calls;
+}
+
+int main(int argc, char** argv) {
+    const size_t rounds = argc > 1 ? std::stoul(argv[1]) : 20000;
+
+    const std::vector<Case> cases = {
+        { "isEmail", R"(^[A-Za-z0-9._%+-]+@[A-Za-z0-9.-]+\.[A-Za-z]{2,}$)", Validators::isEmail,
+            { "user.name+tag@mail.example.com", "admin@hotel.ru", "user@localhost", "@mail.com", "not an email" } },
+        { "isPhone", R"(^$|^\+?\d{10,15}$)", Validators::isPhone,
+            { "+79991234567", "89991234567", "", "+7999", "phone" } },
+        { "isPassword", R"(^.{8,}$)", Validators::isPassword,
+            { "correct horse battery staple", "12345678", "short" } },
+        { "isId", R"(^\d+$)", Validators::isId,
+            { "1", "4294967295", "", "12a" } },
+        { "isPrice", R"(^\d+[.,]\d+$)", Validators::isPrice,
+            { "1200.50", "10,5", "12.", "12" } },
+        { "isDate", R"-(^\d{4}-(0[1-9]|1[0-2])-(0[1-9]|[12]\d|3[01])$)-", Validators::isDate,
+            { "2024-02-29", "2024-13-01", "2024-01-00", "yesterday" } },
+    };
+
+    // Every result lands here so that no loop is optimized away
+    size_t matched = 0;
+
+    std::println("{} rounds per input, ns per call", rounds);
+    std::println("{:<12} {:>12} {:>16} {:>16}", "validator", "matcher", "regex prebuilt", "regex per call");
+
+    for (auto const& test : cases) {
+        const size_t calls = rounds * test.inputs.size();
+
+        const double matcher = nsPerCall(calls, [&] {
+            for (size_t i = 0; i < rounds; ++i)
+                for (auto const& input : test.inputs)
+                    matched += test.matcher(input);
+        });
+
+        const std::regex prebuilt(test.pattern);
+        const double regex = nsPerCall(calls, [&] {
+            for (size_t i = 0; i < rounds; ++i)
+                for (auto const& input : test.inputs)
+                    matched += std::regex_match(input, prebuilt);
+        });
+
+        // Construction dominates, a tenth of the rounds is plenty
+        const size_t slow_rounds = rounds / 10 ? rounds / 10 : 1;
+        const double perCall = nsPerCall(slow_rounds * test.inputs.size(), [&] {
+            for (size_t i = 0; i < slow_rounds; ++i)
+                for (auto const& input : test.inputs)
+                    matched += std::regex_match(input, std::regex(test.pattern));
+        });
+
+        std::println("{:<12} {:>12.1f} {:>16.1f} {:>16.1f}", test.name, matcher, regex, perCall);
+    }
+
+    std::println("{} matches", matched);
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "ChangeFeed.hpp"
+#include "../RemoteClient/RemoteClient.hpp"
+
+#include <algorithm>
+
+void ChangeFeed::subscribe(TableID id, std::shared_ptr<RemoteClient> const& client) {
+    auto& feed = this->table(id);
+    std::lock_guard lock(feed.mtx);
+
+    for (auto const& subscriber : feed.subscribers)
+        if (subscriber.lock() == client) return;
+    feed.subscribers.push_back(client);
+}
+
+void ChangeFeed::unsubscribe(TableID id, RemoteClient const& client) {
+    auto& feed = this->table(id);
+    std::lock_guard lock(feed.mtx);
+
+    std::erase_if(feed.subscribers, [&client](std::weak_ptr<RemoteClient> const& subscriber) {
+        auto locked = subscriber.lock();
+        return !locked || locked.get() == &client;
+    });
+}
+
+void ChangeFeed::unsubscribeAll(RemoteClient const& client) {
+    for (auto const* table : s_tables)
+        this->unsubscribe(table->id, client);
+}
+
+bool ChangeFeed::hasSubscribers(TableID id) {
+    auto& feed = this->table(id);
+    std::lock_guard lock(feed.mtx);
+    return !feed.subscribers.empty();
+}
+
+uint64_t ChangeFeed::sequence(TableID id) {
+    auto& feed = this->table(id);
+    std::lock_guard lock(feed.mtx);
+    return feed.sequence;
+}
+
+void ChangeFeed::publishRow(DatabasePool::Lease& db, TableID id, RowChange change, int64_t rowID) {
+    if (!this->hasSubscribers(id)) return;
+
+    auto& query = db.prepare(tableStatements(id).select_row);
+    query.bind(1, rowID);
+    if (!query.executeStep()) return;
+
+    nlohmann::json row = nlohmann::json::object();
+    for (int i = 0; i < query.getColumnCount(); ++i) {
+        auto column = query.getColumn(i);
+
+        // SQLite's type codes are extern constants, so no switch here
+        const int type = column.getType();
+        if (type == SQLite::INTEGER)
+            row[column.getName()] = column.getInt64();
+        else if (type == SQLite::FLOAT)
+            row[column.getName()] = column.getDouble();
+        else if (type == SQLite::TEXT)
+            row[column.getName()] = column.getString();
+        else
+            row[column.getName()] = nullptr;
+    }
+
+    this->publish(id, RowChangePacket(id, change, rowID, std::move(row)));
+}
+
+void ChangeFeed::publishDelete(TableID id, int64_t rowID) {
+    if (!this->hasSubscribers(id)) return;
+    this->publish(id, RowChangePacket(id, RowChange::Deleted, rowID));
+}
+
+void ChangeFeed::publish(TableID id, RowChangePacket&& packet) {
+    auto& feed = this->table(id);
+    std::lock_guard lock(feed.mtx);
+
+    // Queued under the lock, a GetData answer stamped with this number is queued after it.
+    // sendData only appends to the outbox, a slow peer does not hold the lock up
+    packet.setSequence(++feed.sequence);
+
+    std::erase_if(feed.subscribers, [](std::weak_ptr<RemoteClient> const& subscriber) { return subscriber.expired(); });
+    for (auto const& subscriber : feed.subscribers) {
+        auto client = subscriber.lock();
+        if (!client || client->isDisconnecting) continue;
+        client->sendData(packet);
+    }
+}
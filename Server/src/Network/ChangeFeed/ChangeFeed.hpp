@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "../Core/DatabaseSchema.hpp"
+#include "../PacketManager/Packets/RowChangePacket/RowChangePacket.hpp"
+#include "../../Utils/DatabasePool/DatabasePool.hpp"
+
+class RemoteClient;
+
+// Row level change notifications. Clients subscribe per table, writers
+// publish once their statement committed and every subscriber gets a
+// RowChangePacket for the row instead of fetching the whole table again.
+//
+// Subscribers are held weakly, a dropped connection simply stops receiving
+// and is pruned on the next publish.
+//
+// Every published change gets the next number of its table's sequence and
+// is queued to the subscribers under the table's lock. GetData reads the
+// sequence before its snapshot, so each change it may have missed comes with
+// a higher number, and each one it already contains reaches the client first.
+class ChangeFeed
+{
+private:
+	struct Table {
+		std::mutex									mtx;
+		std::vector<std::weak_ptr<RemoteClient>>	subscribers;
+		uint64_t									sequence = 0;
+	};
+
+	std::array<Table, s_tables.size()>	m_tables;
+
+	Table& table(TableID id) { return m_tables.at(static_cast<size_t>(id)); }
+	void publish(TableID id, RowChangePacket&& packet);
+
+public:
+	void subscribe(TableID id, std::shared_ptr<RemoteClient> const& client);
+	void unsubscribe(TableID id, RemoteClient const& client);
+	void unsubscribeAll(RemoteClient const& client);
+	bool hasSubscribers(TableID id);
+	// The last number handed out for the table
+	uint64_t sequence(TableID id);
+
+	// Reads the row back through db, the connection that just wrote it
+	void publishRow(DatabasePool::Lease& db, TableID id, RowChange change, int64_t rowID);
+	void publishDelete(TableID id, int64_t rowID);
+};
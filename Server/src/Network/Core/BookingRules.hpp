@@ -0,0 +1,31 @@
+#pragma once
+#include <stdint.h>
+#include <optional>
+#include <string>
+
+#include "../../Utils/Json.hpp"
+#include "../../Utils/DatabasePool/DatabasePool.hpp"
+
+// A room holds one live booking per night. Stays are half-open date ranges
+// [check_in, check_out), cancelled bookings free their nights again.
+namespace BookingRules {
+	// Backed by idx_bookings_room_dates, ?4 is the booking being edited (NULL for a new one)
+	inline constexpr const char* overlap_sql =
+		"SELECT EXISTS(SELECT 1 FROM Bookings "
+		"  WHERE room_id = ?1 AND check_in_date < ?3 AND check_out_date > ?2 "
+		"  AND status <> 'отменено' AND (?4 IS NULL OR id <> ?4));";
+
+	inline bool isCancelled(std::string const& status) {
+		return status == "отменено";
+	}
+
+	inline bool overlaps(DatabasePool::Lease& db, nlohmann::json const& roomId, std::string const& checkIn,
+		std::string const& checkOut, std::optional<int64_t> excludeId = std::nullopt) {
+		auto& query = db.prepare(overlap_sql);
+		DatabasePool::bind(query, 1, roomId);
+		query.bind(2, checkIn);
+		query.bind(3, checkOut);
+		if (excludeId) query.bind(4, *excludeId);
+		return query.executeStep() && query.getColumn(0).getInt() != 0;
+	}
+}
@@ -10,4 +10,6 @@ struct ClientData {
 	bool		isLoggedIn;
 	std::string login;
 	UserRole	role;
+	// Empty until the login created a session, see SessionStore
+	std::string sessionToken;
 };
\ No newline at end of file
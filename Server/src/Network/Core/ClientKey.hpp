@@ -4,4 +4,7 @@
 struct ClientKey { 
 	uint32_t host; 
 	uint16_t port; 
+
+	uint64_t value() const { return uint64_t(host) | uint64_t(port) << 32; }
+	static ClientKey fromValue(uint64_t value) { return ClientKey{ uint32_t(value), uint16_t(value >> 32) }; }
 };
\ No newline at end of file
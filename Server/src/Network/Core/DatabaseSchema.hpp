@@ -1,13 +1,280 @@
 #pragma once
-#include <map>
+#include <stdint.h>
+#include <array>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <format>
+
+#include "../../Utils/Json.hpp"
+#include "../../Utils/Validators.hpp"
 
 enum class TableID {
 	USERS,
 	ROOMS,
 	BOOKINGS
 };
-static const std::unordered_map<TableID, std::string> s_tableIDmap = {
-	{ TableID::USERS,		"Users" },
-	{ TableID::ROOMS,		"Rooms" },
-	{ TableID::BOOKINGS,	"Bookings" },
-};
\ No newline at end of file
+
+// One column of a table, everything the server knows about it lives here.
+// definition is the SQL after the column name in CREATE TABLE, default_value
+// is appended as its DEFAULT and is what an insert stores when a client
+// leaves the column out.
+struct ColumnSchema {
+	std::string_view	name;
+	std::string_view	definition;
+	std::string_view	default_value = {};
+	bool				queryable = true;	// GetData may filter and order by it
+	bool				writable = true;	// AddData and EditData may set it
+	bool				(*validate)(std::string_view) = nullptr;	// format of string values
+	std::string_view	error = {};
+};
+
+struct TableSchema {
+	TableID							id;
+	std::string_view				name;
+	std::span<const ColumnSchema>	columns;
+	std::string_view				constraints = {};	// table constraints after the columns
+
+	constexpr ColumnSchema const* find(std::string_view column) const {
+		for (auto const& desc : columns)
+			if (desc.name == column) return &desc;
+		return nullptr;
+	}
+
+	constexpr bool isQueryable(std::string_view column) const {
+		auto desc = find(column);
+		return desc && desc->queryable;
+	}
+
+	constexpr bool isWritable(std::string_view column) const {
+		auto desc = find(column);
+		return desc && desc->writable;
+	}
+
+	constexpr size_t writableCount() const {
+		size_t count = 0;
+		for (auto const& desc : columns)
+			if (desc.writable) ++count;
+		return count;
+	}
+
+	// Position among the writable columns, -1 for anything else
+	constexpr int writableIndex(std::string_view column) const {
+		int index = 0;
+		for (auto const& desc : columns) {
+			if (!desc.writable) continue;
+			if (desc.name == column) return index;
+			++index;
+		}
+		return -1;
+	}
+};
+
+inline constexpr ColumnSchema s_usersColumns[] = {
+	{ .name = "id",				.definition = "INTEGER PRIMARY KEY AUTOINCREMENT", .writable = false },
+	{ .name = "email",			.definition = "TEXT UNIQUE NOT NULL", .validate = Validators::isEmail, .error = "Invalid email format" },
+	{ .name = "password_hash",	.definition = "TEXT NOT NULL", .queryable = false, .validate = Validators::isPassword, .error = "Password must be at least 8 characters" },
+	{ .name = "first_name",		.definition = "TEXT NOT NULL", .validate = Validators::isName, .error = "Invalid first name" },
+	{ .name = "last_name",		.definition = "TEXT NOT NULL", .validate = Validators::isName, .error = "Invalid last name" },
+	{ .name = "phone_number",	.definition = "TEXT", .validate = Validators::isPhone, .error = "Invalid phone number" },
+	{ .name = "role",			.definition = "TEXT CHECK(role IN ('guest', 'admin')) NOT NULL", .default_value = "'guest'", .validate = Validators::isUserRole, .error = "Invalid role value" },
+	{ .name = "created_at",		.definition = "DATETIME", .default_value = "CURRENT_TIMESTAMP", .writable = false },
+	{ .name = "updated_at",		.definition = "DATETIME", .default_value = "CURRENT_TIMESTAMP", .writable = false },
+};
+
+inline constexpr ColumnSchema s_roomsColumns[] = {
+	{ .name = "id",					.definition = "INTEGER PRIMARY KEY AUTOINCREMENT", .writable = false },
+	{ .name = "room_type",			.definition = "TEXT NOT NULL" },
+	{ .name = "price_per_night",	.definition = "REAL NOT NULL", .validate = Validators::isPrice, .error = "Invalid price value" },
+	{ .name = "capacity",			.definition = "INTEGER NOT NULL", .validate = Validators::isUnsigned, .error = "Invalid capacity value" },
+	{ .name = "availability",		.definition = "BOOLEAN NOT NULL", .default_value = "1", .validate = Validators::isFlag, .error = "Invalid availability value" },
+	{ .name = "description",		.definition = "TEXT" },
+};
+
+inline constexpr ColumnSchema s_bookingsColumns[] = {
+	{ .name = "id",				.definition = "INTEGER PRIMARY KEY AUTOINCREMENT", .writable = false },
+	{ .name = "user_id",		.definition = "INTEGER NOT NULL", .validate = Validators::isId, .error = "Invalid user ID value" },
+	{ .name = "room_id",		.definition = "INTEGER NOT NULL", .validate = Validators::isId, .error = "Invalid room ID value" },
+	{ .name = "check_in_date",	.definition = "DATETIME NOT NULL", .validate = Validators::isDate, .error = "Invalid check in date value" },
+	{ .name = "check_out_date",	.definition = "DATETIME NOT NULL", .validate = Validators::isDate, .error = "Invalid check out date value" },
+	{ .name = "booking_date",	.definition = "DATETIME", .default_value = "CURRENT_TIMESTAMP", .writable = false },
+	{ .name = "status",			.definition = "TEXT CHECK(status IN ('подтверждено', 'отменено', 'завершено')) NOT NULL", .default_value = "'подтверждено'", .validate = Validators::isBookingStatus, .error = "Invalid status value" },
+};
+
+inline constexpr TableSchema s_usersTable = { TableID::USERS, "Users", s_usersColumns };
+inline constexpr TableSchema s_roomsTable = { TableID::ROOMS, "Rooms", s_roomsColumns };
+inline constexpr TableSchema s_bookingsTable = {
+	TableID::BOOKINGS, "Bookings", s_bookingsColumns,
+	"FOREIGN KEY(user_id) REFERENCES Users(id) ON DELETE CASCADE, "
+	"FOREIGN KEY(room_id) REFERENCES Rooms(id) ON DELETE CASCADE"
+};
+
+// SQL text generated from the descriptors at compile time. Every builder runs
+// twice: with a null buffer it only measures, then it fills an array of
+// exactly that size.
+namespace SchemaSql {
+	class Builder {
+	private:
+		char*	m_out;
+		size_t	m_size = 0;
+
+	public:
+		constexpr explicit Builder(char* out) : m_out(out) { }
+
+		constexpr Builder& operator<<(std::string_view text) {
+			for (char ch : text) {
+				if (m_out) m_out[m_size] = ch;
+				++m_size;
+			}
+			return *this;
+		}
+
+		constexpr Builder& operator<<(size_t number) {
+			char digits[20] = {};
+			size_t count = 0;
+			do {
+				digits[count++] = static_cast<char>('0' + number % 10);
+				number /= 10;
+			} while (number != 0);
+			while (count != 0) *this << std::string_view(&digits[--count], 1);
+			return *this;
+		}
+
+		constexpr size_t size() const { return m_size; }
+	};
+
+	constexpr size_t buildCreate(TableSchema const& table, char* out) {
+		Builder sql(out);
+		sql << "CREATE TABLE IF NOT EXISTS " << table.name << " (";
+		for (size_t i = 0; i < table.columns.size(); ++i) {
+			auto const& column = table.columns[i];
+			if (i != 0) sql << ", ";
+			sql << column.name << " " << column.definition;
+			if (!column.default_value.empty()) sql << " DEFAULT " << column.default_value;
+		}
+		if (!table.constraints.empty()) sql << ", " << table.constraints;
+		sql << ");";
+		return sql.size();
+	}
+
+	// Writable column n is bound as ?(2n+1) - whether the client sent it, and
+	// ?(2n+2) - its value, so one statement serves every subset of columns
+	constexpr size_t buildInsert(TableSchema const& table, char* out) {
+		Builder sql(out);
+		sql << "INSERT INTO " << table.name << " (";
+		bool first = true;
+		for (auto const& column : table.columns) {
+			if (!column.writable) continue;
+			if (!first) sql << ", ";
+			sql << column.name;
+			first = false;
+		}
+		sql << ") VALUES (";
+		size_t param = 1;
+		for (auto const& column : table.columns) {
+			if (!column.writable) continue;
+			if (param != 1) sql << ", ";
+			sql << "CASE WHEN ?" << param << " THEN ?" << param + 1 << " ELSE "
+				<< (column.default_value.empty() ? std::string_view("NULL") : column.default_value) << " END";
+			param += 2;
+		}
+		sql << ")";
+		return sql.size();
+	}
+
+	// Same parameters as the insert, the row id follows the last column pair
+	constexpr size_t buildUpdate(TableSchema const& table, char* out) {
+		Builder sql(out);
+		sql << "UPDATE " << table.name << " SET ";
+		size_t param = 1;
+		for (auto const& column : table.columns) {
+			if (!column.writable) continue;
+			if (param != 1) sql << ", ";
+			sql << column.name << " = CASE WHEN ?" << param << " THEN ?" << param + 1 << " ELSE " << column.name << " END";
+			param += 2;
+		}
+		sql << " WHERE id = ?" << param;
+		return sql.size();
+	}
+
+	// One row by id as clients may see it, for change notifications
+	constexpr size_t buildSelectRow(TableSchema const& table, char* out) {
+		Builder sql(out);
+		sql << "SELECT ";
+		bool first = true;
+		for (auto const& column : table.columns) {
+			if (!column.queryable) continue;
+			if (!first) sql << ", ";
+			sql << column.name;
+			first = false;
+		}
+		sql << " FROM " << table.name << " WHERE id = ?";
+		return sql.size();
+	}
+
+	template<TableSchema const& Table, size_t (*Build)(TableSchema const&, char*)>
+	inline constexpr auto s_text = [] {
+		std::array<char, Build(Table, nullptr) + 1> sql{};
+		Build(Table, sql.data());
+		return sql;
+	}();
+
+	template<TableSchema const& Table, size_t (*Build)(TableSchema const&, char*)>
+	constexpr std::string_view text() {
+		return std::string_view(s_text<Table, Build>.data(), s_text<Table, Build>.size() - 1);
+	}
+}
+
+struct TableStatements {
+	std::string_view create;
+	std::string_view insert;
+	std::string_view update;
+	std::string_view select_row;
+};
+
+template<TableSchema const& Table>
+inline constexpr TableStatements s_tableStatements = {
+	SchemaSql::text<Table, SchemaSql::buildCreate>(),
+	SchemaSql::text<Table, SchemaSql::buildInsert>(),
+	SchemaSql::text<Table, SchemaSql::buildUpdate>(),
+	SchemaSql::text<Table, SchemaSql::buildSelectRow>(),
+};
+
+// In creation order, foreign keys point backwards
+inline constexpr std::array<TableSchema const*, 3> s_tables = { &s_usersTable, &s_roomsTable, &s_bookingsTable };
+
+// Throws std::out_of_range for an id no table has, as the old name map did
+inline TableSchema const& tableSchema(TableID id) {
+	switch (id) {
+	case TableID::USERS:	return s_usersTable;
+	case TableID::ROOMS:	return s_roomsTable;
+	case TableID::BOOKINGS:	return s_bookingsTable;
+	}
+	throw std::out_of_range("Unknown table");
+}
+
+inline TableStatements const& tableStatements(TableID id) {
+	switch (id) {
+	case TableID::USERS:	return s_tableStatements<s_usersTable>;
+	case TableID::ROOMS:	return s_tableStatements<s_roomsTable>;
+	case TableID::BOOKINGS:	return s_tableStatements<s_bookingsTable>;
+	}
+	throw std::out_of_range("Unknown table");
+}
+
+// First problem with a row sent by AddData or EditData, empty when it can be written
+inline std::string checkRow(TableSchema const& table, nlohmann::json const& row) {
+	for (auto const& [key, value] : row.items()) {
+		auto column = table.find(key);
+		if (!column || !column->writable)
+			return std::format("Unknown column: {}", key);
+
+		if (value.is_object() || value.is_array())
+			return "Unsupported data type";
+
+		if (column->validate && value.is_string() && !column->validate(value.get_ref<std::string const&>()))
+			return std::string(column->error);
+	}
+	return {};
+}
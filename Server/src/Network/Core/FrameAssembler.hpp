@@ -0,0 +1,73 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <span>
+
+// Incremental splitter for the length-prefixed stream (uint32 size + payload).
+// Bytes are written straight into the tail of one growing buffer and complete
+// frames are cut off the front, so partial frames survive between reads.
+class FrameAssembler
+{
+public:
+	static constexpr uint32_t header_size = sizeof(uint32_t);
+	static constexpr uint32_t max_frame_size = 10 * 1024 * 1024;
+
+	enum class Result {
+		incomplete,
+		frame,
+		error
+	};
+
+private:
+	std::vector<uint8_t>	m_buffer;
+	size_t					m_begin = 0;
+	size_t					m_end = 0;
+
+public:
+	std::span<uint8_t> prepare(size_t min_free) {
+		if (m_buffer.size() - m_end < min_free) {
+			compact();
+			if (m_buffer.size() - m_end < min_free)
+				m_buffer.resize(m_end + min_free);
+		}
+		return { m_buffer.data() + m_end, m_buffer.size() - m_end };
+	}
+
+	void commit(size_t count) { m_end += count; }
+
+	Result next(std::vector<uint8_t>& frame) {
+		size_t available = m_end - m_begin;
+		if (available < header_size) return Result::incomplete;
+
+		uint32_t size = 0;
+		memcpy(&size, m_buffer.data() + m_begin, header_size);
+		if (size == 0 || size > max_frame_size) return Result::error;
+
+		if (available - header_size < size) {
+			// Make room for the whole frame once instead of growing chunk by chunk
+			if (m_buffer.size() - m_begin < header_size + size) {
+				compact();
+				if (m_buffer.size() < header_size + size)
+					m_buffer.resize(header_size + size);
+			}
+			return Result::incomplete;
+		}
+
+		auto first = m_buffer.begin() + m_begin + header_size;
+		frame.assign(first, first + size);
+		m_begin += header_size + size;
+		if (m_begin == m_end) m_begin = m_end = 0;
+		return Result::frame;
+	}
+
+	size_t buffered() const { return m_end - m_begin; }
+
+private:
+	void compact() {
+		if (m_begin == 0) return;
+		memmove(m_buffer.data(), m_buffer.data() + m_begin, m_end - m_begin);
+		m_end -= m_begin;
+		m_begin = 0;
+	}
+};
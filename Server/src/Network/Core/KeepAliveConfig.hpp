@@ -1,8 +1,8 @@
 #pragma once
-#include <WinSock2.h>
+#include <stdint.h>
 
 struct KeepAliveConfig {
-    u_long ka_idle = 120;
-    u_long ka_intvl = 3;
-    u_long ka_cnt = 5;
+    uint32_t ka_idle = 120;
+    uint32_t ka_intvl = 3;
+    uint32_t ka_cnt = 5;
 };
@@ -0,0 +1,122 @@
+#pragma once
+#include <stdint.h>
+#include <charconv>
+#include <cmath>
+#include <string>
+#include <string_view>
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+// Serializes a query result straight to JSON text while stepping the
+// statement, no per-row DOM is built. The text is meant to be spliced into a
+// ResponsePacket with setRawAdditionalData.
+//   objects:  [{"id":1,"name":"a"},...]                        (older clients)
+//   columnar: {"columns":["id","name"],"rows":[[1,"a"],...]}
+class ResultWriter
+{
+public:
+	enum class Layout {
+		objects,
+		columnar
+	};
+
+	// Steps query to the end or until max_rows rows are written, returns the
+	// number of rows written. With max_rows set the columnar layout also
+	// tells whether the statement had rows left ("has_more")
+	static size_t write(SQLite::Statement& query, Layout layout, std::string& out, size_t max_rows = 0) {
+		const int colCount = query.getColumnCount();
+
+		if (layout == Layout::columnar) {
+			out += "{\"columns\":[";
+			for (int i = 0; i < colCount; ++i) {
+				if (i) out += ',';
+				writeString(query.getColumnName(i), out);
+			}
+			out += "],\"rows\":[";
+		}
+		else {
+			out += '[';
+		}
+
+		size_t rows = 0;
+		while ((max_rows == 0 || rows < max_rows) && query.executeStep()) {
+			if (rows++) out += ',';
+			out += layout == Layout::columnar ? '[' : '{';
+
+			for (int i = 0; i < colCount; ++i) {
+				if (i) out += ',';
+				if (layout == Layout::objects) {
+					writeString(query.getColumnName(i), out);
+					out += ':';
+				}
+				writeValue(query.getColumn(i), out);
+			}
+
+			out += layout == Layout::columnar ? ']' : '}';
+		}
+
+		if (layout == Layout::columnar && max_rows != 0) {
+			const bool more = rows == max_rows && query.executeStep();
+			out += more ? "],\"has_more\":true}" : "],\"has_more\":false}";
+		}
+		else {
+			out += layout == Layout::columnar ? "]}" : "]";
+		}
+		return rows;
+	}
+
+	static void writeValue(SQLite::Column const& col, std::string& out) {
+		char buffer[32];
+
+		// SQLite's type codes are extern constants, so no switch here
+		const int type = col.getType();
+		if (type == SQLite::INTEGER) {
+			auto result = std::to_chars(buffer, buffer + sizeof(buffer), col.getInt64());
+			out.append(buffer, result.ptr);
+		}
+		else if (type == SQLite::FLOAT && std::isfinite(col.getDouble())) {
+			auto result = std::to_chars(buffer, buffer + sizeof(buffer), col.getDouble());
+			out.append(buffer, result.ptr);
+		}
+		else if (type == SQLite::TEXT || type == SQLite::BLOB) {
+			// sqlite wants the pointer fetched before the size
+			auto data = static_cast<const char*>(col.getBlob());
+			writeString(std::string_view(data, col.getBytes()), out);
+		}
+		else {
+			out += "null";
+		}
+	}
+
+	static void writeString(std::string_view value, std::string& out) {
+		static constexpr char hex[] = "0123456789abcdef";
+
+		out += '"';
+		size_t plain = 0;
+		for (size_t i = 0; i < value.size(); ++i) {
+			auto ch = static_cast<unsigned char>(value[i]);
+			if (ch >= 0x20 && ch != '"' && ch != '\\') continue;
+
+			// Copy the unescaped run in one go
+			out.append(value.data() + plain, i - plain);
+			plain = i + 1;
+
+			switch (ch) {
+			case '"':	out += "\\\""; break;
+			case '\\':	out += "\\\\"; break;
+			case '\b':	out += "\\b"; break;
+			case '\f':	out += "\\f"; break;
+			case '\n':	out += "\\n"; break;
+			case '\r':	out += "\\r"; break;
+			case '\t':	out += "\\t"; break;
+			default:
+				out += "\\u00";
+				out += hex[ch >> 4];
+				out += hex[ch & 0xF];
+				break;
+			}
+		}
+		out.append(value.data() + plain, value.size() - plain);
+		out += '"';
+	}
+};
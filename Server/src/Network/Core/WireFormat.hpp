@@ -0,0 +1,10 @@
+#pragma once
+#include <stdint.h>
+
+enum class WireFormat : uint8_t {
+	// base64 JSON, ResponsePacket::additional_data as an embedded JSON string
+	json = 0,
+	binary = 1,
+	// base64 JSON, additional_data as a nested value
+	json_inline = 2,
+};
@@ -8,77 +8,85 @@
 #include "Packets/DeleteDataPacket/DeleteDataPacket.hpp"
 #include "Packets/EditDataPacket/EditDataPacket.hpp"
 #include "Packets/AddDataPacket/AddDataPacket.hpp"
+#include "Packets/ResumeSessionPacket/ResumeSessionPacket.hpp"
+#include "Packets/FreeRoomsPacket/FreeRoomsPacket.hpp"
+#include "Packets/RoomAvailabilityPacket/RoomAvailabilityPacket.hpp"
+#include "Packets/SubscribePacket/SubscribePacket.hpp"
+#include "Packets/RowChangePacket/RowChangePacket.hpp"
+#include "Packets/BatchPacket/BatchPacket.hpp"
+
+#include <array>
+#include <memory>
+#include <string_view>
+
+// How to build a packet of one PacketID and decode its JSON form. Packets
+// with a json_fields table are read by JsonFields::decode() straight from the
+// frame text, the rest still go through a DOM and parse().
+struct PacketDecoder {
+	std::unique_ptr<Packet> (*create)() = [] { return std::make_unique<Packet>(); };
+	std::unique_ptr<Packet> (*fromJson)(std::string_view text, JsonFields::Frame& frame) =
+		[](std::string_view, JsonFields::Frame&) { return std::make_unique<Packet>(); };
+
+	template<typename P>
+	static constexpr PacketDecoder of() {
+		PacketDecoder decoder;
+		decoder.create = []() -> std::unique_ptr<Packet> { return std::make_unique<P>(); };
+		decoder.fromJson = [](std::string_view text, JsonFields::Frame& frame) -> std::unique_ptr<Packet> {
+			auto packet = std::make_unique<P>();
+			if constexpr (requires { P::json_fields; }) {
+				JsonFields::decode(text, *packet, frame);
+				packet->setRequestID(frame.requestID);
+			}
+			else {
+				auto data = nlohmann::json::parse(text);
+				packet->parse(data);
+				frame.requestID = packet->getRequestID();
+				frame.inlineData = data.value("inline_data", false);
+			}
+			return packet;
+		};
+		return decoder;
+	}
+};
+
+// Indexed by PacketID, ids without a packet decode to Unknown
+inline constexpr auto s_packetDecoders = [] {
+	std::array<PacketDecoder, 0x100> table{};
+	table[static_cast<size_t>(PacketID::Login)]				= PacketDecoder::of<LoginPacket>();
+	table[static_cast<size_t>(PacketID::Register)]			= PacketDecoder::of<RegisterPacket>();
+	table[static_cast<size_t>(PacketID::Response)]			= PacketDecoder::of<ResponsePacket>();
+	table[static_cast<size_t>(PacketID::GetData)]			= PacketDecoder::of<GetDataPacket>();
+	table[static_cast<size_t>(PacketID::Logout)]			= PacketDecoder::of<LogoutPacket>();
+	table[static_cast<size_t>(PacketID::DeleteData)]		= PacketDecoder::of<DeleteDataPacket>();
+	table[static_cast<size_t>(PacketID::EditData)]			= PacketDecoder::of<EditDataPacket>();
+	table[static_cast<size_t>(PacketID::AddData)]			= PacketDecoder::of<AddDataPacket>();
+	table[static_cast<size_t>(PacketID::ResumeSession)]		= PacketDecoder::of<ResumeSessionPacket>();
+	table[static_cast<size_t>(PacketID::FreeRooms)]			= PacketDecoder::of<FreeRoomsPacket>();
+	table[static_cast<size_t>(PacketID::RoomAvailability)]	= PacketDecoder::of<RoomAvailabilityPacket>();
+	table[static_cast<size_t>(PacketID::Subscribe)]			= PacketDecoder::of<SubscribePacket>();
+	table[static_cast<size_t>(PacketID::RowChange)]			= PacketDecoder::of<RowChangePacket>();
+	table[static_cast<size_t>(PacketID::Batch)]				= PacketDecoder::of<BatchPacket>();
+	return table;
+}();
 
 class PacketManager
 {
 public:
 	static std::unique_ptr<Packet> CreatePacket(PacketID id) {
-		switch (id)
-		{
-		case PacketID::Login:
-			return std::make_unique<LoginPacket>();
-			break;
-		case PacketID::Register:
-			return std::make_unique<RegisterPacket>();
-			break;
-		case PacketID::Response:
-			return std::make_unique<ResponsePacket>();
-			break;
-		case PacketID::GetData:
-			return std::make_unique<GetDataPacket>();
-			break;
-		case PacketID::Logout:
-			return std::make_unique<LogoutPacket>();
-			break;
-		case PacketID::DeleteData:
-			return std::make_unique<DeleteDataPacket>();
-			break;
-		case PacketID::EditData:
-			return std::make_unique<EditDataPacket>();
-			break;
-		case PacketID::AddData:
-			return std::make_unique<AddDataPacket>();
-			break;
-		default:
-			return std::make_unique<Packet>();
-			break;
-		}
+		return s_packetDecoders[static_cast<uint8_t>(id)].create();
 	}
-	static std::unique_ptr<Packet> CreatePacket(PacketID id, nlohmann::json& data) {
-		switch (id)
-		{
-		case PacketID::Login:
-			return std::make_unique<LoginPacket>(data);
-			break;
-		case PacketID::Register:
-			return std::make_unique<RegisterPacket>(data);
-			break;
-		case PacketID::Response:
-			return std::make_unique<ResponsePacket>(data);
-			break;
-		case PacketID::GetData:
-			return std::make_unique<GetDataPacket>(data);
-			break;
-		case PacketID::Logout:
-			return std::make_unique<LogoutPacket>(data);
-			break;
-		case PacketID::DeleteData:
-			return std::make_unique<DeleteDataPacket>(data);
-			break;
-		case PacketID::EditData:
-			return std::make_unique<EditDataPacket>(data);
-			break;
-		case PacketID::AddData:
-			return std::make_unique<AddDataPacket>(data);
-			break;
-		default:
-			return std::make_unique<Packet>();
-			break;
-		}
+	// Decoded text of a JSON frame, frame receives the keys every packet has
+	static std::unique_ptr<Packet> CreatePacket(std::string_view text, JsonFields::Frame& frame) {
+		frame.type = JsonFields::peekType(text);
+		return s_packetDecoders[static_cast<uint8_t>(frame.type)].fromJson(text, frame);
 	}
-	static std::unique_ptr<Packet> CreatePacket(nlohmann::json& data) {
-		PacketID id = data["type"];
-		return PacketManager::CreatePacket(id, data);
+	static std::unique_ptr<Packet> CreatePacket(BinaryReader& in) {
+		if (in.readU8() != BinaryStream::magic)
+			return std::make_unique<Packet>();
+
+		auto packet = PacketManager::CreatePacket(static_cast<PacketID>(in.readU8()));
+		if (packet->getID() != PacketID::Unknown)
+			packet->parseBinary(in);
+		return packet;
 	}
 };
-
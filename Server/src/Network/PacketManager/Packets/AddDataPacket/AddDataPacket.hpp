@@ -1,17 +1,16 @@
 #pragma once
 #include "../Packet.hpp"
 #include "../../../Core/DatabaseSchema.hpp"
-
-namespace SQLite {
-	class Database;
-}
-
+#include "../WriteResult.hpp"
+#include "../CommitEffects.hpp"
+#include "../../../Core/ClientData.hpp"
+#include "../../../../Utils/DatabasePool/DatabasePool.hpp"
 
 class AddDataPacket : public Packet
 {
 private:
 	TableID			m_table;
-	nlohmann::json	m_data;
+	nlohmann::json	m_data = nlohmann::json::object();
 public:
 	AddDataPacket() = default;
 	AddDataPacket(nlohmann::json& data) { this->parse(data); }
@@ -21,15 +20,14 @@ public:
 	PacketID getID() const override { return PacketID::AddData; }
 	std::string getName() const override { return "AddDataPacket"; }
 
+	static constexpr JsonField<AddDataPacket> json_fields[] = {
+		{ "table",	[](AddDataPacket& p, nlohmann::json& v) { p.m_table = v.get<TableID>(); } },
+		{ "data",	[](AddDataPacket& p, nlohmann::json& v) { p.m_data = JsonFields::object(v); }, false },
+	};
+
 	void parse(nlohmann::json& data) override {
-		m_table = data["table"];
-		m_requestID = data["request_id"];
-		try {
-			m_data = nlohmann::json::parse(data.value("data", "{}"));
-		}
-		catch (...) {
-			m_data = nlohmann::json::object();
-		}
+		Packet::parse(data);
+		JsonFields::read(*this, data);
 	}
 
 	std::string toString() const override {
@@ -45,8 +43,25 @@ public:
 		return json;
 	}
 
+	void writeFields(BinaryWriter& out) const override {
+		out.writeVarint(static_cast<uint64_t>(m_table));
+		out.writeJson(m_data);
+	}
+
+	void readFields(BinaryReader& in) override {
+		m_table = static_cast<TableID>(in.readVarint());
+		m_data = in.readJson();
+		if (!m_data.is_object()) m_data = nlohmann::json::object();
+	}
+
+	// Checks and inserts the row on db without replying, on the WriteQueue thread
+	// inside a write group. afterCommit() follows once the group committed,
+	// a Batch collects the effects of its operations and applies them once
+	WriteResult apply(class Server& server, ClientData const& requester, DatabasePool::Lease& db);
+	void collect(CommitEffects& effects, WriteResult const& result) const;
+	void afterCommit(class Server& server, DatabasePool::Lease& db, WriteResult const& result);
+
 private:
-	bool handleRoomAdd(class Server& server, class RemoteClient& client, SQLite::Database& db, std::string const& tableName);
-	bool handleBookingAdd(class Server& server, class RemoteClient& client, SQLite::Database& db, std::string const& tableName);
+	WriteResult checkBooking(DatabasePool::Lease& db);
 };
 
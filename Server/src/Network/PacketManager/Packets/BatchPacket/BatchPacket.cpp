@@ -0,0 +1,134 @@
+#include "BatchPacket.hpp"
+#include "../../../Server/Server.hpp"
+#include "../ResponsePacket/ResponsePacket.hpp"
+
+#include <algorithm>
+#include <print>
+
+WriteResult BatchPacket::apply(class Server& server, ClientData const& requester, DatabasePool::Lease& db)
+{
+	// Repeated operations on a table reuse one cached statement, only the bindings change
+	m_results.clear();
+	m_results.reserve(m_operations.size());
+
+	for (size_t i = 0; i < m_operations.size(); ++i) {
+		WriteResult result;
+		try {
+			result = std::visit([&](auto& packet) -> WriteResult {
+				if constexpr (std::is_same_v<std::decay_t<decltype(packet)>, std::monostate>)
+					return { ResponseID::EditionError, "Unsupported operation" };
+				else
+					return packet.apply(server, requester, db);
+			}, m_operations[i]);
+		}
+		catch (...) {
+			// A constraint the checks missed. The queue still rolls the batch
+			// back, the reply names the operation
+			m_failed = i;
+			throw;
+		}
+
+		// The queue rolls the whole batch back to its savepoint
+		if (!result) {
+			m_failed = i;
+			return { result.code, std::format("Operation {}: {}", i, result.message) };
+		}
+		m_results.push_back(std::move(result));
+	}
+
+	return {};
+}
+
+void BatchPacket::afterCommit(class Server& server, DatabasePool::Lease& db, WriteResult const& result)
+{
+	// One invalidation per table and at most one availability reload for the
+	// whole batch, the writer thread stays free for the next group
+	CommitEffects effects;
+	for (size_t i = 0; i < m_operations.size(); ++i) {
+		std::visit([&](auto const& packet) {
+			if constexpr (!std::is_same_v<std::decay_t<decltype(packet)>, std::monostate>)
+				packet.collect(effects, m_results[i]);
+		}, m_operations[i]);
+	}
+	effects.apply(server, db);
+
+	std::println("Batch of {} operations committed.", m_operations.size());
+}
+
+void BatchPacket::queue(class Server& server, class RemoteClient& client, ClientData requester, RemoteClient::WriteTicket ticket, BatchPacket&& batch)
+{
+	// Runs as one mutation of a write group, its savepoint makes it all or nothing
+	auto self = std::make_shared<BatchPacket>(std::move(batch));
+	server.getWriteQueue().submit({
+		[self, &server, requester = std::move(requester)](DatabasePool::Lease& db) {
+			return self->apply(server, requester, db);
+		},
+		[self, &server, client = client.shared_from_this(), ticket = std::move(ticket)](DatabasePool::Lease& db, WriteResult const& result) {
+			nlohmann::json data;
+			if (result) {
+				self->afterCommit(server, db, result);
+				data["ids"] = nlohmann::json::array();
+				for (auto const& operation : self->m_results)
+					data["ids"].push_back(operation.rowID);
+			}
+			else if (self->m_failed) {
+				data["failed"] = *self->m_failed;
+			}
+
+			ResponsePacket resp(result.code, result.message, self->m_requestID, std::move(data));
+			client->sendData(resp);
+		}
+	});
+}
+
+void BatchPacket::handlePacket(class Server& server, class RemoteClient& client)
+{
+	try {
+		if (client.clientData.role != UserRole::ADMIN) {
+			ResponsePacket resp(ResponseID::AccessDenied, "Access Denied", m_requestID);
+			client.sendData(resp);
+			return;
+		}
+
+		if (m_operations.empty() || m_operations.size() > max_operations) {
+			ResponsePacket resp(ResponseID::EditionError, std::format("A batch holds 1 to {} operations", max_operations), m_requestID);
+			client.sendData(resp);
+			return;
+		}
+
+		const bool hasPasswords = std::ranges::any_of(m_operations, [](Operation const& operation) {
+			auto edit = std::get_if<EditDataPacket>(&operation);
+			return edit && edit->hasPlainPassword();
+		});
+		if (!hasPasswords) {
+			queue(server, client, client.clientData, client.beginWrite(), std::move(*this));
+			return;
+		}
+
+		// All of the batch's passwords are hashed in one job on the hash executor,
+		// the batch is queued for the writer from there
+		const auto requestID = m_requestID;
+		auto accepted = server.getHashExecutor().tryPost([
+			&server,
+			client = client.shared_from_this(),
+			requester = client.clientData,
+			ticket = client.beginWrite(),
+			batch = std::move(*this)
+		]() mutable {
+			for (auto& operation : batch.m_operations)
+				if (auto edit = std::get_if<EditDataPacket>(&operation)) edit->hashPassword();
+			queue(server, *client, std::move(requester), std::move(ticket), std::move(batch));
+		});
+
+		if (!accepted) {
+			std::println("Batch rejected, hash queue is full.");
+			ResponsePacket resp(ResponseID::InternalError, "Server is busy, try again later", requestID);
+			client.sendData(resp);
+		}
+	}
+	catch (const std::exception& e) {
+		std::println(stderr, "Server error: {}", e.what());
+		ResponsePacket resp(ResponseID::InternalError, "Internal server error", m_requestID);
+		client.sendData(resp);
+	}
+}
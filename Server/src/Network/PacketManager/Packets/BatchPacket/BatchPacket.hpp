@@ -0,0 +1,134 @@
+#pragma once
+#include "../Packet.hpp"
+#include "../AddDataPacket/AddDataPacket.hpp"
+#include "../EditDataPacket/EditDataPacket.hpp"
+#include "../DeleteDataPacket/DeleteDataPacket.hpp"
+#include "../../../RemoteClient/RemoteClient.hpp"
+
+#include <optional>
+#include <stdexcept>
+#include <variant>
+#include <vector>
+
+// AddData, EditData and DeleteData operations sent in one frame and run as
+// one mutation of the WriteQueue, either all of them are committed or none.
+// Operations are encoded as the packets themselves. The response carries
+// {"ids": [...]}, the row each operation wrote in order, or on failure
+// {"failed": index} of the first one refused with its code and message.
+class BatchPacket : public Packet
+{
+public:
+	// monostate stands for an operation type a batch can't carry
+	using Operation = std::variant<std::monostate, AddDataPacket, EditDataPacket, DeleteDataPacket>;
+
+	static constexpr size_t max_operations = 1000;
+
+private:
+	std::vector<Operation>		m_operations;
+	std::vector<WriteResult>	m_results;	// per operation, filled by apply()
+	std::optional<size_t>		m_failed;
+
+	static Operation makeOperation(PacketID id) {
+		switch (id)
+		{
+		case PacketID::AddData:		return AddDataPacket();
+		case PacketID::EditData:	return EditDataPacket();
+		case PacketID::DeleteData:	return DeleteDataPacket();
+		default:					return std::monostate();
+		}
+	}
+
+	void readOperations(nlohmann::json& operations) {
+		if (operations.size() > max_operations) throw std::length_error("Too many batch operations");
+
+		m_operations.clear();
+		m_operations.reserve(operations.size());
+		for (auto& json : operations) {
+			auto operation = makeOperation(json.value("type", PacketID::Unknown));
+			// Operations answer nothing on their own, their request id is left out
+			std::visit([&json](auto& packet) {
+				if constexpr (!std::is_same_v<std::decay_t<decltype(packet)>, std::monostate>)
+					JsonFields::read(packet, json);
+			}, operation);
+			m_operations.push_back(std::move(operation));
+		}
+	}
+
+public:
+	BatchPacket() = default;
+	BatchPacket(nlohmann::json& data) { this->parse(data); }
+
+	void handlePacket(class Server& server, class RemoteClient& client) override;
+
+	PacketID getID() const override { return PacketID::Batch; }
+	std::string getName() const override { return "BatchPacket"; }
+
+	static constexpr JsonField<BatchPacket> json_fields[] = {
+		{ "operations", [](BatchPacket& p, nlohmann::json& v) { p.readOperations(v); }, false },
+	};
+
+	void parse(nlohmann::json& data) override {
+		Packet::parse(data);
+		JsonFields::read(*this, data);
+	}
+
+	std::string toString() const override {
+		return this->toJSON().dump();
+	}
+
+	nlohmann::json toJSON() const override {
+		nlohmann::json json;
+		json["type"] = this->getID();
+		json["request_id"] = m_requestID;
+		auto& operations = json["operations"] = nlohmann::json::array();
+		for (auto const& operation : m_operations) {
+			std::visit([&operations](auto const& packet) {
+				if constexpr (std::is_same_v<std::decay_t<decltype(packet)>, std::monostate>)
+					operations.push_back(nullptr);
+				else
+					operations.push_back(packet.toJSON());
+			}, operation);
+		}
+		return json;
+	}
+
+	void writeFields(BinaryWriter& out) const override {
+		out.writeVarint(m_operations.size());
+		for (auto const& operation : m_operations) {
+			std::visit([&out](auto const& packet) {
+				if constexpr (std::is_same_v<std::decay_t<decltype(packet)>, std::monostate>) {
+					out.writeU8(static_cast<uint8_t>(PacketID::Unknown));
+				}
+				else {
+					out.writeU8(static_cast<uint8_t>(packet.getID()));
+					packet.writeFields(out);
+				}
+			}, operation);
+		}
+	}
+
+	// Hands the batch to the WriteQueue, off the client's strand once its passwords are hashed
+	static void queue(class Server& server, class RemoteClient& client, ClientData requester, RemoteClient::WriteTicket ticket, BatchPacket&& batch);
+
+	WriteResult apply(class Server& server, ClientData const& requester, DatabasePool::Lease& db);
+	void afterCommit(class Server& server, DatabasePool::Lease& db, WriteResult const& result);
+
+	// Unknown operations have no length to skip, they make the frame malformed
+	void readFields(BinaryReader& in) override {
+		const auto count = in.readVarint();
+		if (count > max_operations) throw std::length_error("Too many batch operations");
+
+		m_operations.clear();
+		m_operations.reserve(count);
+		for (uint64_t i = 0; i < count; ++i) {
+			auto operation = makeOperation(static_cast<PacketID>(in.readU8()));
+			std::visit([&in](auto& packet) {
+				if constexpr (std::is_same_v<std::decay_t<decltype(packet)>, std::monostate>)
+					throw std::invalid_argument("Unsupported batch operation");
+				else
+					packet.readFields(in);
+			}, operation);
+			m_operations.push_back(std::move(operation));
+		}
+	}
+};
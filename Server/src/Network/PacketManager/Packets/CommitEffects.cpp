@@ -0,0 +1,31 @@
+#include "CommitEffects.hpp"
+#include "../../Server/Server.hpp"
+
+void CommitEffects::apply(class Server& server, DatabasePool::Lease& db) const
+{
+	for (auto table : invalidated)
+		server.getResultCache().invalidate(table);
+
+	for (auto userID : revokedUsers)
+		server.getSessions().revokeUser(userID);
+
+	auto& availability = server.getAvailability();
+	if (reloadAll) {
+		availability.load(db);
+	}
+	else {
+		for (auto roomID : rooms)
+			availability.reloadRoom(db, roomID);
+		for (auto bookingID : bookings)
+			availability.reloadBooking(db, bookingID);
+	}
+
+	// Subscribers, the sender included, hear of the rows before the response
+	auto& feed = server.getChangeFeed();
+	for (auto const& change : changes) {
+		if (change.change == RowChange::Deleted)
+			feed.publishDelete(change.table, change.rowID);
+		else
+			feed.publishRow(db, change.table, change.change, change.rowID);
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "../../Core/DatabaseSchema.hpp"
+#include "RowChangePacket/RowChangePacket.hpp"
+#include "../../../Utils/DatabasePool/DatabasePool.hpp"
+
+#include <stdint.h>
+#include <set>
+#include <vector>
+
+// What committed writes leave to do once their group committed: cached
+// results to drop, availability to refresh, sessions to revoke and changes
+// to publish. Write packets collect theirs here, a Batch gathers all of its
+// operations in one, so however many rows it touched every table is
+// invalidated and availability reloaded at most once.
+struct CommitEffects {
+	struct Change {
+		TableID		table;
+		RowChange	change;
+		int64_t		rowID;
+	};
+
+	std::set<TableID>		invalidated;
+	std::set<int64_t>		rooms;			// reloaded one by one
+	std::set<int64_t>		bookings;
+	bool					reloadAll = false;	// rooms and bookings above are covered then
+	std::set<int64_t>		revokedUsers;
+	std::vector<Change>		changes;		// in the order they were made
+
+	void apply(class Server& server, DatabasePool::Lease& db) const;
+};
@@ -1,57 +1,96 @@
 #include "DeleteDataPacket.hpp"
 #include "../../../Server/Server.hpp"
 #include "../ResponsePacket/ResponsePacket.hpp"
+#include "../QueueWrite.hpp"
 #include "../GetDataPacket/GetDataPacket.hpp"
 
 #include <print>
 
-void DeleteDataPacket::handlePacket(class Server& server, class RemoteClient& client)
+WriteResult DeleteDataPacket::apply(class Server& server, ClientData const& requester, DatabasePool::Lease& db)
 {
-	try {
-		if (client.clientData.role != UserRole::ADMIN) {
-			ResponsePacket resp(ResponseID::AccessDenied, "Access Denied", m_requestID);
-			client.sendData(resp);
-			return;
-		}
+	auto tableName = tableSchema(m_tableID).name;
 
-		auto& db = server.getDatabase();
+	auto& query = db.prepare(std::format("SELECT * FROM {} WHERE id = ?", tableName));
 
-		auto& tableName = s_tableIDmap.at(m_tableID);
+	query.bind(1, m_recordID);
 
-		std::unique_ptr<SQLite::Statement> query = std::make_unique<SQLite::Statement>(db, std::format("SELECT * FROM {} WHERE id = ?", tableName));
+	if (!query.executeStep()) {
+		std::string errStr = std::format("Can't find data id = {} from {}.", m_recordID, static_cast<int>(m_tableID));
+		std::println("{}", errStr);
+		return { ResponseID::DeletionError, std::move(errStr) };
+	}
+	
+	if(m_tableID == TableID::USERS) {
+		auto emailIndex = query.getColumnIndex("email");
+		auto targetLogin = query.getColumn(emailIndex).getString();
+		if (requester.login == targetLogin)
+			return { ResponseID::AccessDenied, "Cannot delete yourself" };
+	}
+
+	// Bookings that go with a user or room are announced as deleted too
+	m_cascaded.clear();
+	if (m_tableID != TableID::BOOKINGS && server.getChangeFeed().hasSubscribers(TableID::BOOKINGS)) {
+		auto& bookings = db.prepare(m_tableID == TableID::USERS
+			? "SELECT id FROM Bookings WHERE user_id = ?"
+			: "SELECT id FROM Bookings WHERE room_id = ?");
+		bookings.bind(1, m_recordID);
+		while (bookings.executeStep())
+			m_cascaded.push_back(bookings.getColumn(0).getInt64());
+	}
+
+	auto& deleteQuery = db.prepare(std::format("DELETE FROM {} WHERE id = ?", tableName));
 
-		query->bind(1, m_recordID);
+	deleteQuery.bind(1, m_recordID);
+
+	deleteQuery.exec();
+	return { ResponseID::Sucess, "", m_recordID };
+}
+
+void DeleteDataPacket::collect(CommitEffects& effects, WriteResult const& result) const
+{
+	// Users and rooms take their bookings with them
+	effects.invalidated.insert(m_tableID);
+	if (m_tableID != TableID::BOOKINGS)
+		effects.invalidated.insert(TableID::BOOKINGS);
 
-		if (!query->executeStep()) {
-			std::string errStr = std::format("Can't find data id = {} from {}.", m_recordID, static_cast<int>(m_tableID));
-			std::println("{}", errStr);
-			ResponsePacket resp(ResponseID::DeletionError, errStr, m_requestID);
+	// A deleted account must not be resumable
+	if (m_tableID == TableID::USERS)
+		effects.revokedUsers.insert(m_recordID);
+
+	// Deleting a user cascades to bookings of any room, that one reloads everything
+	if (m_tableID == TableID::BOOKINGS)
+		effects.bookings.insert(m_recordID);
+	else if (m_tableID == TableID::ROOMS)
+		effects.rooms.insert(m_recordID);
+	else
+		effects.reloadAll = true;
+
+	effects.changes.push_back({ m_tableID, RowChange::Deleted, m_recordID });
+	for (auto bookingID : m_cascaded)
+		effects.changes.push_back({ TableID::BOOKINGS, RowChange::Deleted, bookingID });
+}
+
+void DeleteDataPacket::afterCommit(class Server& server, DatabasePool::Lease& db, WriteResult const& result)
+{
+	CommitEffects effects;
+	this->collect(effects, result);
+	effects.apply(server, db);
+}
+
+void DeleteDataPacket::handlePacket(class Server& server, class RemoteClient& client)
+{
+	try {
+		if (client.clientData.role != UserRole::ADMIN) {
+			ResponsePacket resp(ResponseID::AccessDenied, "Access Denied", m_requestID);
 			client.sendData(resp);
 			return;
 		}
-		
-		if(m_tableID == TableID::USERS) {
-			auto emailIndex = query->getColumnIndex("email");
-			auto targetLogin = query->getColumn(emailIndex).getString();
-			if (client.clientData.login == targetLogin) {
-				ResponsePacket resp(ResponseID::AccessDenied, "Cannot delete yourself", m_requestID);
-				client.sendData(resp);
-				return;
-			}
-		}
-		
-		query = std::make_unique<SQLite::Statement>(db, std::format("DELETE FROM {} WHERE id = ?", tableName));
 
-		query->bind(1, m_recordID);
-
-		query->exec();
-
-		ResponsePacket resp(ResponseID::Sucess, "", m_requestID);
-		client.sendData(resp);
+		queueWrite(server, client, std::move(*this));
 	}
 	catch (const std::exception& e) {
 		std::println(stderr, "Server error: {}", e.what());
 		ResponsePacket resp(ResponseID::InternalError, "Internal server error", m_requestID);
 		client.sendData(resp);
 	}
-}
\ No newline at end of file
+}
@@ -1,12 +1,19 @@
 #pragma once
 #include "../Packet.hpp"
 #include "../../../Core/DatabaseSchema.hpp"
+#include "../WriteResult.hpp"
+#include "../CommitEffects.hpp"
+#include "../../../Core/ClientData.hpp"
+#include "../../../../Utils/DatabasePool/DatabasePool.hpp"
+
+#include <vector>
 
 class DeleteDataPacket : public Packet
 {
 private:
 	TableID  m_tableID;
 	int64_t m_recordID;
+	std::vector<int64_t> m_cascaded;	// bookings the delete takes along, for the change feed
 public:
 	DeleteDataPacket() = default;
 	DeleteDataPacket(TableID tableID, int64_t recordID) : m_tableID(tableID), m_recordID(recordID) { }
@@ -26,10 +33,14 @@ public:
 		return "DeleteDataPacket";
 	}
 
+	static constexpr JsonField<DeleteDataPacket> json_fields[] = {
+		{ "table_id",	[](DeleteDataPacket& p, nlohmann::json& v) { p.m_tableID = v.get<TableID>(); } },
+		{ "record_id",	[](DeleteDataPacket& p, nlohmann::json& v) { p.m_recordID = v.get<int64_t>(); } },
+	};
+
 	void parse(nlohmann::json& data) override {
-		m_tableID = data["table_id"];
-		m_recordID = data["record_id"];
-		m_requestID = data["request_id"];
+		Packet::parse(data);
+		JsonFields::read(*this, data);
 	}
 
 	std::string toString() const override {
@@ -44,5 +55,22 @@ public:
 		json["record_id"] = m_recordID;
 		return json;
 	}
+
+	void writeFields(BinaryWriter& out) const override {
+		out.writeVarint(static_cast<uint64_t>(m_tableID));
+		out.writeSVarint(m_recordID);
+	}
+
+	void readFields(BinaryReader& in) override {
+		m_tableID = static_cast<TableID>(in.readVarint());
+		m_recordID = in.readSVarint();
+	}
+
+	// Checks and deletes the row on db without replying, on the WriteQueue thread
+	// inside a write group. afterCommit() follows once the group committed,
+	// a Batch collects the effects of its operations and applies them once
+	WriteResult apply(class Server& server, ClientData const& requester, DatabasePool::Lease& db);
+	void collect(CommitEffects& effects, WriteResult const& result) const;
+	void afterCommit(class Server& server, DatabasePool::Lease& db, WriteResult const& result);
 };
 
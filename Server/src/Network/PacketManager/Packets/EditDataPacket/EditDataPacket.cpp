@@ -1,30 +1,29 @@
 #include "EditDataPacket.hpp"
 #include "../../../Server/Server.hpp"
 #include "../ResponsePacket/ResponsePacket.hpp"
+#include "../QueueWrite.hpp"
 #include "../GetDataPacket/GetDataPacket.hpp"
+#include "../../../Core/BookingRules.hpp"
 
 #include <bcrypt_.h>
 #include <unordered_set>
-#include <regex>
 #include <print>
 
-bool EditDataPacket::handleUserEdit(class Server& server, class RemoteClient& client, SQLite::Database& db, std::string const& tableName)
+WriteResult EditDataPacket::checkUserEdit(ClientData const& requester, DatabasePool::Lease& db, std::string_view tableName)
 {
-	auto query = SQLite::Statement(db, std::format("SELECT email FROM {} WHERE id = ?", tableName));
+	auto& query = db.prepare(std::format("SELECT email FROM {} WHERE id = ?", tableName));
 
 	query.bind(1, m_recordID);
 
 	if (!query.executeStep()) {
 		std::string errStr = std::format("Can't find record id = {} in table {}.", m_recordID, tableName);
 		std::println("{}", errStr);
-		ResponsePacket resp(ResponseID::EditionError, errStr, m_requestID);
-		client.sendData(resp);
-		return false;
+		return { ResponseID::EditionError, std::move(errStr) };
 	}
 
 	std::string targetEmail = query.getColumn(0).getString();
 
-	const bool isEditingSelf = (client.clientData.login == targetEmail);
+	const bool isEditingSelf = (requester.login == targetEmail);
 
 	if (isEditingSelf) {
 		static const std::unordered_set<std::string> allowedFields = {
@@ -33,154 +32,142 @@ bool EditDataPacket::handleUserEdit(class Server& server, class RemoteClient& cl
 
 		for (auto it = m_newData.begin(); it != m_newData.end(); ++it) {
 			const std::string& key = it.key();
-			if (!allowedFields.contains(key)) {
-				ResponsePacket resp(ResponseID::AccessDenied,
-					std::format("Admins cannot change their own {}", key),
-					m_requestID);
-				client.sendData(resp);
-				return false;
-			}
+			if (!allowedFields.contains(key))
+				return { ResponseID::AccessDenied, std::format("Admins cannot change their own {}", key) };
 		}
 	}
 
-	std::regex email_regex(R"(^[A-Za-z0-9._%+-]+@[A-Za-z0-9.-]+\.[A-Za-z]{2,}$)");
-	std::regex phone_regex(R"(^$|^\+?\d{10,15}$)");
-	std::regex password_regex(R"(^.{8,}$)");
+	return {};
+}
 
-	for (const auto& [key, value] : m_newData.items()) {
-		if (!value.is_string()) continue;
 
-		const std::string str = value.get<std::string>();
+WriteResult EditDataPacket::checkBooking(DatabasePool::Lease& db)
+{
+	auto& query = db.prepare(
+		"SELECT "
+		"  ?1 IS NULL OR EXISTS(SELECT 1 FROM Users WHERE id = ?1) AS user_ok, "
+		"  ?2 IS NULL OR EXISTS(SELECT 1 FROM Rooms WHERE id = ?2) AS room_ok;"
+	);
+	// Only the references the edit changes are checked
+	DatabasePool::bind(query, 1, m_newData.value("user_id", nlohmann::json()));
+	DatabasePool::bind(query, 2, m_newData.value("room_id", nlohmann::json()));
 
-		if (key == "email" && !std::regex_match(str, email_regex)) {
-			ResponsePacket resp(ResponseID::EditionError, "Invalid email format", m_requestID);
-			client.sendData(resp);
-			return false;
-		}
-		if (key == "phone_number" && !std::regex_match(str, phone_regex)) {
-			ResponsePacket resp(ResponseID::EditionError, "Invalid phone number", m_requestID);
-			client.sendData(resp);
-			return false;
-		}
-		if (key == "password_hash" && !std::regex_match(str, password_regex)) {
-			ResponsePacket resp(ResponseID::EditionError,
-				"Password must be at least 8 characters", m_requestID);
-			client.sendData(resp);
-			return false;
-		}
-	}
+	if (!query.executeStep())
+		return { ResponseID::EditionError, "Unknown error" };
 
-	return true;
-}
+	bool userExists = query.getColumn(0).getInt() != 0;
+	bool roomExists = query.getColumn(1).getInt() != 0;
+	if (!userExists)
+		return { ResponseID::EditionError, "User does not exist" };
+	else if (!roomExists)
+		return { ResponseID::EditionError, "Room does not exist" };
 
+	if (!m_newData.contains("room_id") && !m_newData.contains("check_in_date")
+		&& !m_newData.contains("check_out_date") && !m_newData.contains("status"))
+		return {};
 
-bool EditDataPacket::handleRoomEdit(class Server& server, class RemoteClient& client, SQLite::Database& db, std::string const& tableName) 
-{
-	std::regex price_regex(R"(^\d+[.,]\d+$)");
-	std::regex capacity_regex(R"(^\d+$)");
-	std::regex availability_regex(R"(^[01]$)");
+	// The stay as it will be after the edit, fields not sent keep their stored values
+	auto& current = db.prepare("SELECT room_id, check_in_date, check_out_date, status FROM Bookings WHERE id = ?");
+	current.bind(1, m_recordID);
 
-	for (const auto& [key, value] : m_newData.items()) {
-		if (!value.is_string()) continue;
+	if (!current.executeStep())
+		return { ResponseID::EditionError, std::format("Can't find record id = {} in table Bookings.", m_recordID) };
 
-		const std::string str = value.get<std::string>();
+	const auto roomId = m_newData.contains("room_id") ? m_newData["room_id"] : nlohmann::json(current.getColumn(0).getInt64());
+	const auto checkIn = m_newData.value("check_in_date", current.getColumn(1).getString());
+	const auto checkOut = m_newData.value("check_out_date", current.getColumn(2).getString());
+	const auto status = m_newData.value("status", current.getColumn(3).getString());
 
-		if (key == "price_per_night" && !std::regex_match(str, price_regex)) {
-			ResponsePacket resp(ResponseID::EditionError, "Invalid price value", m_requestID);
-			client.sendData(resp);
-			return false;
-		}
-		if (key == "capacity" && !std::regex_match(str, capacity_regex)) {
-			ResponsePacket resp(ResponseID::EditionError, "Invalid capacity value", m_requestID);
-			client.sendData(resp);
-			return false;
-		}
-		if (key == "availability" && !std::regex_match(str, availability_regex)) {
-			ResponsePacket resp(ResponseID::EditionError, "Invalid availability value", m_requestID);
-			client.sendData(resp);
-			return false;
-		}
-	}
-	return true;
+	if (checkIn >= checkOut)
+		return { ResponseID::EditionError, "Check out date must be after check in date" };
+
+	if (!BookingRules::isCancelled(status) && BookingRules::overlaps(db, roomId, checkIn, checkOut, m_recordID))
+		return { ResponseID::EditionError, "Room is already booked for these dates" };
+
+	return {};
 }
-bool EditDataPacket::handleBookingEdit(class Server& server, class RemoteClient& client, SQLite::Database& db, std::string const& tableName) 
+
+bool EditDataPacket::hasPlainPassword() const
 {
-	std::regex id_regex(R"(^\d+$)");
-	std::regex date_regex(R"-(^\d{4}-(0[1-9]|1[0-2])-(0[1-9]|[12]\d|3[01])$)-");
-	std::regex status_regex(R"-(^(подтверждено|отменено|завершено)$)-");
+	auto it = m_newData.find("password_hash");
+	if (m_passwordHashed || it == m_newData.end() || !it->is_string()) return false;
 
-	for (const auto& [key, value] : m_newData.items()) {
-		if (!value.is_string()) continue;
+	// The format is checked on the plain text, apply() refuses a bad one
+	return Validators::isPassword(it->get_ref<std::string const&>());
+}
 
-		const std::string str = value.get<std::string>();
+void EditDataPacket::hashPassword()
+{
+	if (!this->hasPlainPassword()) return;
 
-		if (key == "user_id" && !std::regex_match(str, id_regex)) {
-			ResponsePacket resp(ResponseID::EditionError, "Invalid user ID value", m_requestID);
-			client.sendData(resp);
-			return false;
-		}
-		if (key == "room_id" && !std::regex_match(str, id_regex)) {
-			ResponsePacket resp(ResponseID::EditionError, "Invalid room ID value", m_requestID);
-			client.sendData(resp);
-			return false;
-		}
-		if (key == "check_in_date" && !std::regex_match(str, date_regex)) {
-			ResponsePacket resp(ResponseID::EditionError, "Invalid check in date value", m_requestID);
-			client.sendData(resp);
-			return false;
-		}
-		if (key == "check_out_date" && !std::regex_match(str, date_regex)) {
-			ResponsePacket resp(ResponseID::EditionError, "Invalid check out date value", m_requestID);
-			client.sendData(resp);
-			return false;
-		}		
-		if (key == "status" && !std::regex_match(str, status_regex)) {
-			ResponsePacket resp(ResponseID::EditionError, "Invalid status value", m_requestID);
-			client.sendData(resp);
-			return false;
-		}
-	}
+	auto& password = m_newData["password_hash"];
+	password = bcrypt::generateHash(password.get<std::string>());
+	m_passwordHashed = true;
+}
 
-	SQLite::Statement query(db,
-		"SELECT "
-		"  EXISTS(SELECT 1 FROM Users WHERE id = ?) AS user_ok, "
-		"  EXISTS(SELECT 1 FROM Rooms WHERE id = ?) AS room_ok;"
-	);
-	query.bind(1, m_newData["user_id"].get<std::string>());
-	query.bind(2, m_newData["room_id"].get<std::string>());
+WriteResult EditDataPacket::apply(class Server& server, ClientData const& requester, DatabasePool::Lease& db)
+{
+	if (m_newData.empty())
+		return { ResponseID::EditionError, "No fields to update" };
 
-	if (!query.executeStep()) {
-		ResponsePacket resp(ResponseID::EditionError, "Unknown error", m_requestID);
-		client.sendData(resp);
-		return false;
+	auto const& table = tableSchema(m_tableID);
+
+	if (auto error = checkRow(table, m_newData); !error.empty())
+		return { ResponseID::EditionError, std::move(error) };
+
+	// handlePacket() hashes before queueing, plain text never reaches the table
+	if (m_newData.contains("password_hash") && !m_passwordHashed) {
+		std::println(stderr, "Edit of record {} in {} reached the writer with an unhashed password.", m_recordID, table.name);
+		return { ResponseID::InternalError, "Internal server error" };
 	}
 
-	bool userExists = query.getColumn(0).getInt() != 0;
-	bool roomExists = query.getColumn(1).getInt() != 0;
-	if (!userExists) {
-		ResponsePacket resp(ResponseID::EditionError, "User does not exist", m_requestID);
-		client.sendData(resp);
-		return false;
+	if (m_tableID == TableID::USERS) {
+		if (auto result = this->checkUserEdit(requester, db, table.name); !result) return result;
 	}
-	else if (!roomExists) {
-		ResponsePacket resp(ResponseID::EditionError, "Room does not exist", m_requestID);
-		client.sendData(resp);
-		return false;
+	else if (m_tableID == TableID::BOOKINGS) {
+		if (auto result = this->checkBooking(db); !result) return result;
+	}
+
+	// Columns left out of m_newData keep their flag unbound and their value
+	auto& updateQuery = db.prepare(tableStatements(m_tableID).update);
+	for (auto const& [key, value] : m_newData.items()) {
+		const int param = 2 * table.writableIndex(key) + 1;
+		updateQuery.bind(param, 1);
+		DatabasePool::bind(updateQuery, param + 1, value);
 	}
 
-	return true;
+	updateQuery.bind(static_cast<int>(2 * table.writableCount() + 1), m_recordID);
+	updateQuery.exec();
+
+	std::println("Updated record {} in {}.", m_recordID, table.name);
+	return { ResponseID::Sucess, "", m_recordID };
+}
+
+void EditDataPacket::collect(CommitEffects& effects, WriteResult const& result) const
+{
+	effects.invalidated.insert(m_tableID);
+
+	if (m_tableID == TableID::BOOKINGS)
+		effects.bookings.insert(m_recordID);
+	else if (m_tableID == TableID::ROOMS)
+		effects.rooms.insert(m_recordID);
+
+	// Sessions carry the login and role of the time they were created
+	if (m_tableID == TableID::USERS && (m_newData.contains("email") || m_newData.contains("role") || m_newData.contains("password_hash")))
+		effects.revokedUsers.insert(m_recordID);
+
+	effects.changes.push_back({ m_tableID, RowChange::Edited, m_recordID });
+}
+
+void EditDataPacket::afterCommit(class Server& server, DatabasePool::Lease& db, WriteResult const& result)
+{
+	CommitEffects effects;
+	this->collect(effects, result);
+	effects.apply(server, db);
 }
 
 void EditDataPacket::handlePacket(class Server& server, class RemoteClient& client)
 {
-	auto join = [](const std::vector<std::string>& parts, const std::string& delim) -> std::string {
-		std::ostringstream oss;
-		for (size_t i = 0; i < parts.size(); ++i) {
-			if (i != 0) oss << delim;
-			oss << parts[i];
-		}
-		return oss.str();
-	};
 	try {
 		if (client.clientData.role != UserRole::ADMIN) {
 			ResponsePacket resp(ResponseID::AccessDenied, "Access Denied", m_requestID);
@@ -188,66 +175,33 @@ void EditDataPacket::handlePacket(class Server& server, class RemoteClient& clie
 			return;
 		}
 
-		auto& db = server.getDatabase();
-		const auto& tableName = s_tableIDmap.at(m_tableID);
-
-		if (m_tableID == TableID::USERS && !this->handleUserEdit(server, client, db, tableName)) return;
-		else if (m_tableID == TableID::ROOMS && !this->handleRoomEdit(server, client, db, tableName)) return;
-		else if (m_tableID == TableID::BOOKINGS && !this->handleBookingEdit(server, client, db, tableName)) return;
-
-		std::vector<std::string> setParts;
-		std::vector<std::string> keys;
-		for (auto& [key, value] : m_newData.items()) {
-			setParts.push_back(std::format("{} = ?", key));
-			keys.push_back(key);
-		}
-
-		if (setParts.empty()) {
-			ResponsePacket resp(ResponseID::EditionError, "No fields to update", m_requestID);
-			client.sendData(resp);
+		if (!this->hasPlainPassword()) {
+			queueWrite(server, client, std::move(*this));
 			return;
 		}
 
-		std::string setClause = join(setParts, ", ");
-		std::string sql = std::format("UPDATE {} SET {} WHERE id = ?", tableName, setClause);
-
-		SQLite::Statement updateQuery(db, sql);
-
-		int bindIndex = 1;
-		for (const auto& key : keys) {
-			const auto& val = m_newData[key];
-
-			if (val.is_null()) {
-				updateQuery.bind(bindIndex++, nullptr);
-			}
-			else if (val.is_number_integer()) {
-				updateQuery.bind(bindIndex++, val.get<int64_t>());
-			}
-			else if (val.is_number_float()) {
-				updateQuery.bind(bindIndex++, val.get<double>());
-			}
-			else if (val.is_string()) {
-				if(key == "password_hash") updateQuery.bind(bindIndex++, bcrypt::generateHash(val.get<std::string>()));
-				else updateQuery.bind(bindIndex++, val.get<std::string>());
-			}
-			else {
-				ResponsePacket resp(ResponseID::EditionError, "Unsupported data type", m_requestID);
-				client.sendData(resp);
-				return;
-			}
+		// bcrypt runs on the hash executor, the edit is queued for the writer from there
+		const auto requestID = m_requestID;
+		auto accepted = server.getHashExecutor().tryPost([
+			&server,
+			client = client.shared_from_this(),
+			requester = client.clientData,
+			ticket = client.beginWrite(),
+			edit = std::move(*this)
+		]() mutable {
+			edit.hashPassword();
+			queueWrite(server, *client, std::move(requester), std::move(ticket), std::move(edit));
+		});
+
+		if (!accepted) {
+			std::println("Edit of record {} rejected, hash queue is full.", m_recordID);
+			ResponsePacket resp(ResponseID::InternalError, "Server is busy, try again later", requestID);
+			client.sendData(resp);
 		}
-
-		updateQuery.bind(bindIndex, m_recordID);
-		updateQuery.exec();
-
-		std::println("Updated record {} in {}.", m_recordID, tableName);
-
-		ResponsePacket resp(ResponseID::Sucess, "", m_requestID);
-		client.sendData(resp);
 	}
 	catch (const std::exception& e) {
 		std::println(stderr, "Edit error: {}", e.what());
 		ResponsePacket resp(ResponseID::InternalError, "Internal server error", m_requestID);
 		client.sendData(resp);
 	}
-}
\ No newline at end of file
+}
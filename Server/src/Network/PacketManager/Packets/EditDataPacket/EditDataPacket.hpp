@@ -1,17 +1,18 @@
 #pragma once
 #include "../Packet.hpp"
 #include "../../../Core/DatabaseSchema.hpp"
-
-namespace SQLite {
-	class Database;
-}
+#include "../WriteResult.hpp"
+#include "../CommitEffects.hpp"
+#include "../../../Core/ClientData.hpp"
+#include "../../../../Utils/DatabasePool/DatabasePool.hpp"
 
 class EditDataPacket : public Packet
 {
 private:
 	TableID			m_tableID;
 	int64_t			m_recordID;
-	nlohmann::json	m_newData;
+	nlohmann::json	m_newData = nlohmann::json::object();
+	bool			m_passwordHashed = false;	// password_hash in m_newData is a hash already
 
 public:
 	EditDataPacket() = default;
@@ -35,16 +36,15 @@ public:
 		return "EditDataPacket";
 	}
 
+	static constexpr JsonField<EditDataPacket> json_fields[] = {
+		{ "table_id",	[](EditDataPacket& p, nlohmann::json& v) { p.m_tableID = v.get<TableID>(); } },
+		{ "record_id",	[](EditDataPacket& p, nlohmann::json& v) { p.m_recordID = v.get<int64_t>(); } },
+		{ "new_data",	[](EditDataPacket& p, nlohmann::json& v) { p.m_newData = JsonFields::object(v); }, false },
+	};
+
 	void parse(nlohmann::json& data) override {
-		m_tableID = data["table_id"];
-		m_recordID = data["record_id"];
-		m_requestID = data["request_id"];
-		try {
-			m_newData = nlohmann::json::parse(data.value("new_data", "{}"));
-		}
-		catch (...) {
-			m_newData = nlohmann::json::object();
-		}
+		Packet::parse(data);
+		JsonFields::read(*this, data);
 	}
 
 	std::string toString() const override {
@@ -60,8 +60,33 @@ public:
 		json["new_data"] = m_newData.dump();
 		return json;
 	}
+
+	void writeFields(BinaryWriter& out) const override {
+		out.writeVarint(static_cast<uint64_t>(m_tableID));
+		out.writeSVarint(m_recordID);
+		out.writeJson(m_newData);
+	}
+
+	void readFields(BinaryReader& in) override {
+		m_tableID = static_cast<TableID>(in.readVarint());
+		m_recordID = in.readSVarint();
+		m_newData = in.readJson();
+		if (!m_newData.is_object()) m_newData = nlohmann::json::object();
+	}
+
+	// A valid password_hash still in plain text. hashPassword() replaces it with
+	// its bcrypt hash, on the hash executor before the edit is queued for the writer
+	bool hasPlainPassword() const;
+	void hashPassword();
+
+	// Checks and updates the row on db without replying, on the WriteQueue thread
+	// inside a write group. afterCommit() follows once the group committed,
+	// a Batch collects the effects of its operations and applies them once
+	WriteResult apply(class Server& server, ClientData const& requester, DatabasePool::Lease& db);
+	void collect(CommitEffects& effects, WriteResult const& result) const;
+	void afterCommit(class Server& server, DatabasePool::Lease& db, WriteResult const& result);
+
 private:
-	bool handleUserEdit(class Server& server, class RemoteClient& client, SQLite::Database& db, std::string const& tableName);
-	bool handleRoomEdit(class Server& server, class RemoteClient& client, SQLite::Database& db, std::string const& tableName);
-	bool handleBookingEdit(class Server& server, class RemoteClient& client, SQLite::Database& db, std::string const& tableName);
+	WriteResult checkUserEdit(ClientData const& requester, DatabasePool::Lease& db, std::string_view tableName);
+	WriteResult checkBooking(DatabasePool::Lease& db);
 };
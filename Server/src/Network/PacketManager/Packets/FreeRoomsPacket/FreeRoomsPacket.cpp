@@ -0,0 +1,51 @@
+#include "FreeRoomsPacket.hpp"
+#include "../../../Server/Server.hpp"
+#include "../ResponsePacket/ResponsePacket.hpp"
+#include "../../../Core/ResultWriter.hpp"
+#include "../../../../Utils/Validators.hpp"
+
+#include <print>
+
+void FreeRoomsPacket::handleQuery(class Server& server, class RemoteClient& client, ClientData const& requester)
+{
+	try {
+		if (!requester.isLoggedIn) {
+			ResponsePacket resp(ResponseID::AccessDenied, "Access Denied", m_requestID);
+			client.sendData(resp);
+			return;
+		}
+
+		if (!Validators::isDate(m_checkIn) || !Validators::isDate(m_checkOut) || m_checkIn >= m_checkOut) {
+			ResponsePacket resp(ResponseID::InvalidTable, "Invalid query: bad date range", m_requestID);
+			client.sendData(resp);
+			return;
+		}
+
+		auto db = server.getReader();
+
+		// Per room the NOT EXISTS probe is a range scan of idx_bookings_room_dates
+		auto& query = db.prepare(
+			"SELECT * FROM Rooms AS r "
+			"WHERE r.availability = 1 AND r.capacity >= ?1 "
+			"AND NOT EXISTS (SELECT 1 FROM Bookings AS b "
+			"  WHERE b.room_id = r.id AND b.check_in_date < ?3 AND b.check_out_date > ?2 "
+			"  AND b.status <> 'отменено') "
+			"ORDER BY r.id"
+		);
+		query.bind(1, static_cast<int64_t>(m_capacity));
+		query.bind(2, m_checkIn);
+		query.bind(3, m_checkOut);
+
+		std::string result;
+		ResultWriter::write(query, ResultWriter::Layout::columnar, result);
+
+		ResponsePacket resp(ResponseID::Sucess, "", m_requestID);
+		resp.setRawAdditionalData(std::move(result));
+		client.sendData(resp);
+	}
+	catch (const std::exception& e) {
+		std::println(stderr, "Server error: {}", e.what());
+		ResponsePacket resp(ResponseID::InternalError, "Internal server error", m_requestID);
+		client.sendData(resp);
+	}
+}
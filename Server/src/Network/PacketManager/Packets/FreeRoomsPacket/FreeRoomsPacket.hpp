@@ -0,0 +1,59 @@
+#pragma once
+#include "../Packet.hpp"
+
+// Rooms that are available, hold at least m_capacity guests and have no
+// live booking overlapping [m_checkIn, m_checkOut). Answered with the
+// columnar ResultWriter layout of Rooms rows.
+class FreeRoomsPacket : public Packet
+{
+private:
+	std::string	m_checkIn;
+	std::string	m_checkOut;
+	uint32_t	m_capacity = 0;
+public:
+	FreeRoomsPacket() = default;
+	FreeRoomsPacket(nlohmann::json& data) { this->parse(data); }
+
+	bool isReadOnly() const override { return true; }
+	void handleQuery(class Server& server, class RemoteClient& client, ClientData const& requester) override;
+
+	PacketID getID() const override { return PacketID::FreeRooms; }
+	std::string getName() const override { return "FreeRoomsPacket"; }
+
+	static constexpr JsonField<FreeRoomsPacket> json_fields[] = {
+		{ "check_in",	[](FreeRoomsPacket& p, nlohmann::json& v) { p.m_checkIn = JsonFields::take(v); } },
+		{ "check_out",	[](FreeRoomsPacket& p, nlohmann::json& v) { p.m_checkOut = JsonFields::take(v); } },
+		{ "capacity",	[](FreeRoomsPacket& p, nlohmann::json& v) { p.m_capacity = v.get<uint32_t>(); }, false },
+	};
+
+	void parse(nlohmann::json& data) override {
+		Packet::parse(data);
+		JsonFields::read(*this, data);
+	}
+
+	std::string toString() const override {
+		return this->toJSON().dump();
+	}
+
+	nlohmann::json toJSON() const override {
+		nlohmann::json json;
+		json["type"] = this->getID();
+		json["request_id"] = m_requestID;
+		json["check_in"] = m_checkIn;
+		json["check_out"] = m_checkOut;
+		json["capacity"] = m_capacity;
+		return json;
+	}
+
+	void writeFields(BinaryWriter& out) const override {
+		out.writeString(m_checkIn);
+		out.writeString(m_checkOut);
+		out.writeVarint(m_capacity);
+	}
+
+	void readFields(BinaryReader& in) override {
+		m_checkIn = in.readString();
+		m_checkOut = in.readString();
+		m_capacity = static_cast<uint32_t>(in.readVarint());
+	}
+};
@@ -1,66 +1,167 @@
 #include "GetDataPacket.hpp"
 #include "../../../Server/Server.hpp"
 #include "../ResponsePacket/ResponsePacket.hpp"
+#include "../../../Core/ResultWriter.hpp"
 
+#include <algorithm>
+#include <stdexcept>
 #include <print>
 
-void GetDataPacket::handlePacket(class Server& server, class RemoteClient& client) 
+static const char* comparisonOperator(FilterOp op)
+{
+	switch (op) {
+	case FilterOp::eq:	return "=";
+	case FilterOp::ne:	return "<>";
+	case FilterOp::lt:	return "<";
+	case FilterOp::le:	return "<=";
+	case FilterOp::gt:	return ">";
+	case FilterOp::ge:	return ">=";
+	default:			throw std::invalid_argument("Unknown filter operator");
+	}
+}
+
+// Filter values are matched literally, LIKE wildcards in them are escaped
+static std::string escapeLike(std::string const& value)
+{
+	std::string escaped;
+	escaped.reserve(value.size());
+	for (char ch : value) {
+		if (ch == '%' || ch == '_' || ch == '\\') escaped += '\\';
+		escaped += ch;
+	}
+	return escaped;
+}
+
+std::string GetDataPacket::buildQuery(TableSchema const& table, std::vector<nlohmann::json>& params) const
+{
+	// Column names go into the SQL text, only known ones get there
+	auto checkColumn = [&table](std::string const& column) {
+		if (!table.isQueryable(column))
+			throw std::invalid_argument(std::format("Unknown column: {}", column));
+	};
+
+	std::vector<std::string> conditions;
+	for (auto const& filter : m_query.filters) {
+		checkColumn(filter.column);
+
+		if (filter.op == FilterOp::contains || filter.op == FilterOp::prefix) {
+			if (!filter.value.is_string())
+				throw std::invalid_argument(std::format("Text filter on {} needs a string", filter.column));
+
+			auto pattern = escapeLike(filter.value.get<std::string>());
+			conditions.push_back(std::format("{} LIKE ? ESCAPE '\\'", filter.column));
+			params.push_back(filter.op == FilterOp::contains ? '%' + pattern + '%' : pattern + '%');
+		}
+		else {
+			conditions.push_back(std::format("{} {} ?", filter.column, comparisonOperator(filter.op)));
+			params.push_back(filter.value);
+		}
+	}
+
+	const std::string orderBy = m_query.order_by.empty() ? "id" : m_query.order_by;
+	checkColumn(orderBy);
+	const char* direction = m_query.descending ? "DESC" : "ASC";
+
+	// Keyset page: rows strictly after the cursor in (orderBy, id) order
+	if (m_query.after_id) {
+		const char* comparison = m_query.descending ? "<" : ">";
+		if (orderBy == "id") {
+			conditions.push_back(std::format("id {} ?", comparison));
+		}
+		else {
+			conditions.push_back(std::format("({}, id) {} (?, ?)", orderBy, comparison));
+			params.push_back(m_query.after_value);
+		}
+		params.push_back(*m_query.after_id);
+	}
+
+	std::string sql = std::format("SELECT * FROM {}", table.name);
+	for (size_t i = 0; i < conditions.size(); ++i) {
+		sql += i == 0 ? " WHERE " : " AND ";
+		sql += conditions[i];
+	}
+
+	sql += std::format(" ORDER BY {} {}", orderBy, direction);
+	if (orderBy != "id") sql += std::format(", id {}", direction);
+
+	if (m_query.limit != 0) {
+		// One row over the page tells ResultWriter whether there is more
+		sql += " LIMIT ? OFFSET ?";
+		params.push_back(std::min(m_query.limit, DataQuery::max_limit) + 1);
+		params.push_back(m_query.offset);
+	}
+	else if (m_query.offset != 0) {
+		sql += " LIMIT -1 OFFSET ?";
+		params.push_back(m_query.offset);
+	}
+
+	return sql;
+}
+
+void GetDataPacket::handleQuery(class Server& server, class RemoteClient& client, ClientData const& requester)
 {
 	try {
-		if (client.clientData.role != UserRole::ADMIN) {
+		if (requester.role != UserRole::ADMIN) {
 			ResponsePacket resp(ResponseID::AccessDenied, "Access Denied", m_requestID);
 			client.sendData(resp);
 			return;
 		}
 
-		auto& db = server.getDatabase();
-
-		auto& tableName = s_tableIDmap.at(m_table);
-
-		std::string sql = std::format("SELECT * FROM {}", tableName);
-		SQLite::Statement query(db, sql);
-
-		nlohmann::json result = nlohmann::json::array();
-
-		bool hasData = false;
-		while (query.executeStep()) {
-			hasData = true;
-
-			int colCount = query.getColumnCount();
-			nlohmann::json row;
-
-			for (int i = 0; i < colCount; ++i) {
-				auto col = query.getColumn(i);
-				std::string colName = col.getName();
-
-				if (col.isNull()) {
-					row[colName] = nullptr;
-				}
-				else if (col.getType() == SQLite::INTEGER) {
-					row[colName] = col.getInt64();
-				}
-				else if (col.getType() == SQLite::FLOAT) {
-					row[colName] = col.getDouble();
-				}
-				else if (col.getType() == SQLite::TEXT) {
-					row[colName] = col.getString();
-				}
-				else if (col.getType() == SQLite::BLOB) {
-					std::string blob(reinterpret_cast<const char*>(col.getBlob()), col.getBytes());
-					row[colName] = blob;
-				}
-			}
-			result.push_back(row);
+		auto const& table = tableSchema(m_table);
+
+		// Everything besides the table that shapes the result text
+		BinaryWriter key;
+		key.writeU8(m_columnar);
+		m_query.write(key);
+
+		// Taken before the cache and the snapshot, changes past it reach the client as
+		// deltas with a higher number. A cached entry is invalidated before a change is
+		// published, so it holds every change up to the number as well, see ChangeFeed
+		const uint64_t sequence = server.getChangeFeed().sequence(m_table);
+
+		auto& cache = server.getResultCache();
+		if (auto cached = cache.find(m_table, key.data())) {
+			ResponsePacket resp(ResponseID::Sucess, "", m_requestID);
+			resp.setRawAdditionalData(std::move(cached));
+			resp.setSequence(sequence);
+			client.sendData(resp);
+			return;
 		}
 
-		if (!hasData) {
-			std::println("Invalid table or no data: {}.", tableName);
+		// Taken before the read snapshot starts, see ResultCache
+		const uint64_t generation = cache.generation(m_table);
+
+		auto db = server.getReader();
+
+		std::vector<nlohmann::json> params;
+		std::string sql = this->buildQuery(table, params);
+
+		auto& query = db.prepare(sql);
+		for (size_t i = 0; i < params.size(); ++i)
+			DatabasePool::bind(query, static_cast<int>(i + 1), params[i]);
+
+		std::string result;
+		auto layout = m_columnar ? ResultWriter::Layout::columnar : ResultWriter::Layout::objects;
+		const size_t pageSize = m_query.limit != 0 ? std::min(m_query.limit, DataQuery::max_limit) : 0;
+
+		// An empty page of a filtered query is a valid answer, an empty table is not
+		if (ResultWriter::write(query, layout, result, pageSize) == 0 && m_query.empty()) {
+			std::println("Invalid table or no data: {}.", table.name);
 			ResponsePacket resp(ResponseID::InvalidTable, "Invalid table or no data", m_requestID);
 			client.sendData(resp);
 			return;
 		}
 
-		ResponsePacket resp(ResponseID::Sucess, "", m_requestID, result);
+		auto text = std::make_shared<const std::string>(std::move(result));
+		cache.store(m_table, generation, key.release(), text);
+
+		ResponsePacket resp(ResponseID::Sucess, "", m_requestID);
+		resp.setRawAdditionalData(std::move(text));
+		resp.setSequence(sequence);
+		client.sendData(resp);
+	}
+	catch (const std::invalid_argument& e) {
+		ResponsePacket resp(ResponseID::InvalidTable, std::format("Invalid query: {}", e.what()), m_requestID);
 		client.sendData(resp);
 	}
 	catch (const std::exception& e) {
@@ -68,4 +169,4 @@ void GetDataPacket::handlePacket(class Server& server, class RemoteClient& clien
 		ResponsePacket resp(ResponseID::InternalError, "Internal server error", m_requestID);
 		client.sendData(resp);
 	}
-}
\ No newline at end of file
+}
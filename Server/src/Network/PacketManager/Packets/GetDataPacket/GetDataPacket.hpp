@@ -1,24 +1,35 @@
 #pragma once
 #include "../Packet.hpp"
 #include "../../../Core/DatabaseSchema.hpp"
+#include "../../../Core/DataQuery.hpp"
 
 class GetDataPacket : public Packet
 {
 private:
-	TableID m_table;
+	TableID		m_table;
+	// Client reads the {"columns", "rows"} layout, see ResultWriter
+	bool		m_columnar = false;
+	DataQuery	m_query;
 public:
 	GetDataPacket() = default;
 	GetDataPacket(TableID table) : m_table(table) { }
 	GetDataPacket(nlohmann::json& data) { this->parse(data); }
 
-	void handlePacket(class Server& server, class RemoteClient& client) override;
+	bool isReadOnly() const override { return true; }
+	void handleQuery(class Server& server, class RemoteClient& client, ClientData const& requester) override;
 
 	PacketID getID() const override { return PacketID::GetData; }
 	std::string getName() const override { return "GetDataPacket"; }
 
+	static constexpr JsonField<GetDataPacket> json_fields[] = {
+		{ "table",		[](GetDataPacket& p, nlohmann::json& v) { p.m_table = v.get<TableID>(); } },
+		{ "columnar",	[](GetDataPacket& p, nlohmann::json& v) { p.m_columnar = v.get<bool>(); }, false },
+		{ "query",		[](GetDataPacket& p, nlohmann::json& v) { p.m_query = v.get<DataQuery>(); }, false },
+	};
+
 	void parse(nlohmann::json& data) override {
-		m_table = data["table"];
-		m_requestID = data["request_id"];
+		Packet::parse(data);
+		JsonFields::read(*this, data);
 	}
 
 	std::string toString() const override {
@@ -30,7 +41,28 @@ public:
 		json["type"] = this->getID();
 		json["request_id"] = m_requestID;
 		json["table"] = m_table;
+		json["columnar"] = m_columnar;
+		if (!m_query.empty()) json["query"] = m_query;
 		return json;
 	}
-};
 
+	void writeFields(BinaryWriter& out) const override {
+		out.writeVarint(static_cast<uint64_t>(m_table));
+		out.writeU8(m_columnar);
+		out.writeU8(!m_query.empty());
+		if (!m_query.empty()) m_query.write(out);
+	}
+
+	void readFields(BinaryReader& in) override {
+		m_table = static_cast<TableID>(in.readVarint());
+		m_columnar = in.readU8() != 0;
+		// Older binary clients end the packet here
+		m_query = DataQuery();
+		if (!in.atEnd() && in.readU8()) m_query.read(in);
+	}
+
+private:
+	// SELECT for m_query, fills params in placeholder order. Throws
+	// std::invalid_argument on columns or values the query may not use
+	std::string buildQuery(TableSchema const& table, std::vector<nlohmann::json>& params) const;
+};
@@ -0,0 +1,291 @@
+#pragma once
+#include "../PacketID.hpp"
+#include "../../../Utils/Json.hpp"
+
+#include <stdint.h>
+#include <format>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// One top level key of a packet's JSON form. Packets list theirs in a static
+// json_fields table, the JSON counterpart of readFields(). Scalars reach read()
+// as a json holding only that value, objects and arrays as the tree built for
+// that key alone. A required key missing from the frame makes it a bad packet,
+// as the [] lookups of the old parse() did.
+template<typename P>
+struct JsonField {
+	std::string_view	name;
+	void				(*read)(P& packet, nlohmann::json& value);
+	bool				required = true;
+};
+
+// Decoding of JSON frames straight into packets with the SAX interface of
+// nlohmann::json, without a DOM of the whole frame. peekType() finds the
+// packet type, then decode() runs the type's fields.
+namespace JsonFields {
+	// Keys every packet has besides its own
+	struct Frame {
+		PacketID	type = PacketID::Unknown;
+		uint64_t	requestID = 0;
+		bool		inlineData = false;		// client accepts additional_data nested
+	};
+
+	inline std::string take(nlohmann::json& value) {
+		return std::move(value.get_ref<std::string&>());
+	}
+
+	// An object sent nested, or as JSON text like older clients do. Text that
+	// doesn't parse is an empty object, as it always was
+	inline nlohmann::json object(nlohmann::json& value) {
+		if (value.is_object()) return std::move(value);
+		try {
+			auto parsed = nlohmann::json::parse(value.get_ref<std::string const&>());
+			if (parsed.is_object()) return parsed;
+		}
+		catch (nlohmann::json::parse_error const&) { }
+		return nlohmann::json::object();
+	}
+
+	// The packet's own fields from a DOM, for operations nested in a Batch
+	template<typename P>
+	void read(P& packet, nlohmann::json& data) {
+		for (auto const& field : P::json_fields) {
+			auto it = data.find(std::string(field.name));
+			if (it != data.end()) field.read(packet, *it);
+			else if (field.required) throw std::invalid_argument(std::format("Missing field {}", field.name));
+		}
+	}
+
+	// Events of everything below the top level object that nobody reads
+	class Skipper {
+	protected:
+		size_t m_depth = 0;
+
+	public:
+		bool null() { return true; }
+		bool boolean(bool) { return true; }
+		bool number_integer(nlohmann::json::number_integer_t) { return true; }
+		bool number_unsigned(nlohmann::json::number_unsigned_t) { return true; }
+		bool number_float(nlohmann::json::number_float_t, std::string const&) { return true; }
+		bool string(std::string&) { return true; }
+		bool key(std::string&) { return true; }
+		bool start_object(size_t) { ++m_depth; return true; }
+		bool end_object() { --m_depth; return true; }
+		bool start_array(size_t) { ++m_depth; return true; }
+		bool end_array() { --m_depth; return true; }
+		bool parse_error(size_t, std::string const&, nlohmann::json::exception const& ex) {
+			throw std::invalid_argument(ex.what());
+		}
+	};
+
+	// Stops at the top level "type", which the client writes after most fields.
+	// Only a number right after the key counts, any other event clears it
+	class TypeReader : public Skipper {
+		bool		m_typeKey = false;
+
+		bool other() { m_typeKey = false; return true; }
+
+	public:
+		PacketID	type = PacketID::Unknown;
+
+		bool null() { return this->other(); }
+		bool boolean(bool) { return this->other(); }
+		bool number_float(nlohmann::json::number_float_t, std::string const&) { return this->other(); }
+		bool string(std::string&) { return this->other(); }
+		bool start_object(size_t elements) { this->other(); return Skipper::start_object(elements); }
+		bool end_object() { this->other(); return Skipper::end_object(); }
+		bool start_array(size_t elements) { this->other(); return Skipper::start_array(elements); }
+		bool end_array() { this->other(); return Skipper::end_array(); }
+
+		bool key(std::string& name) {
+			m_typeKey = m_depth == 1 && name == "type";
+			return true;
+		}
+		bool number_unsigned(nlohmann::json::number_unsigned_t value) {
+			if (!m_typeKey) return true;
+			type = value <= 0xFF ? static_cast<PacketID>(value) : PacketID::Unknown;
+			return false;
+		}
+		bool number_integer(nlohmann::json::number_integer_t value) {
+			if (!m_typeKey) return true;
+			type = value >= 0 && value <= 0xFF ? static_cast<PacketID>(value) : PacketID::Unknown;
+			return false;
+		}
+	};
+
+	inline PacketID peekType(std::string_view text) {
+		TypeReader reader;
+		nlohmann::json::sax_parse(text.data(), text.data() + text.size(), &reader);
+		return reader.type;
+	}
+
+	// Tree of one nested value from its events, what json::parse gives for
+	// that value alone
+	class TreeBuilder {
+		nlohmann::json&					m_root;
+		std::vector<nlohmann::json*>	m_open;		// objects and arrays not closed yet
+		nlohmann::json*					m_member = nullptr;	// slot of the last key
+
+		template<typename V>
+		nlohmann::json* add(V&& value) {
+			if (m_open.empty()) {
+				m_root = nlohmann::json(std::forward<V>(value));
+				return &m_root;
+			}
+			auto& parent = *m_open.back();
+			if (parent.is_array()) {
+				parent.push_back(nlohmann::json(std::forward<V>(value)));
+				return &parent.back();
+			}
+			*m_member = nlohmann::json(std::forward<V>(value));
+			return m_member;
+		}
+
+	public:
+		explicit TreeBuilder(nlohmann::json& root) : m_root(root) { }
+
+		bool null() { this->add(nullptr); return true; }
+		bool boolean(bool value) { this->add(value); return true; }
+		bool number_integer(nlohmann::json::number_integer_t value) { this->add(value); return true; }
+		bool number_unsigned(nlohmann::json::number_unsigned_t value) { this->add(value); return true; }
+		bool number_float(nlohmann::json::number_float_t value, std::string const&) { this->add(value); return true; }
+		bool string(std::string& value) { this->add(std::move(value)); return true; }
+
+		bool key(std::string& name) {
+			m_member = &(*m_open.back())[name];
+			return true;
+		}
+
+		bool start_object(size_t) { m_open.push_back(this->add(nlohmann::json::value_t::object)); return true; }
+		bool end_object() { m_open.pop_back(); return true; }
+		bool start_array(size_t) { m_open.push_back(this->add(nlohmann::json::value_t::array)); return true; }
+		bool end_array() { m_open.pop_back(); return true; }
+	};
+
+	template<typename P>
+	class Reader {
+		static_assert(std::size(P::json_fields) <= 64, "One bit per field in m_seen");
+
+		// m_field for keys that aren't in P::json_fields
+		static constexpr int skip = -1;
+		static constexpr int request_id = -2;
+		static constexpr int inline_data = -3;
+
+		P&				m_packet;
+		Frame&			m_frame;
+		size_t			m_depth = 0;
+		int				m_field = skip;
+		uint64_t		m_seen = 0;
+		bool			m_hasRequestID = false;
+		// Tree of the nested value being read, only for a key someone takes
+		nlohmann::json	m_value;
+		std::optional<TreeBuilder> m_builder;
+
+		bool nested() const { return m_depth > 1; }
+
+		void apply(nlohmann::json& value) {
+			if (m_field >= 0) {
+				P::json_fields[m_field].read(m_packet, value);
+				m_seen |= uint64_t(1) << m_field;
+			}
+			else if (m_field == request_id) {
+				m_frame.requestID = value.get<uint64_t>();
+				m_hasRequestID = true;
+			}
+			else if (m_field == inline_data) {
+				m_frame.inlineData = value.get<bool>();
+			}
+		}
+
+		template<typename T>
+		bool scalar(T&& value) {
+			if (m_depth == 0) throw std::invalid_argument("Packet is not an object");
+			if (nested()) return true;
+			if (m_field == skip) return true;
+			nlohmann::json json(std::forward<T>(value));
+			this->apply(json);
+			return true;
+		}
+
+		bool open() {
+			if (m_depth++ == 1 && m_field != skip) m_builder.emplace(m_value);
+			return true;
+		}
+
+		bool close() {
+			if (--m_depth != 1 || !m_builder) return true;
+			m_builder.reset();
+			this->apply(m_value);
+			m_value = nullptr;
+			return true;
+		}
+
+	public:
+		Reader(P& packet, Frame& frame) : m_packet(packet), m_frame(frame) { }
+
+		bool null() { return m_builder ? m_builder->null() : this->scalar(nullptr); }
+		bool boolean(bool value) { return m_builder ? m_builder->boolean(value) : this->scalar(value); }
+		bool number_integer(nlohmann::json::number_integer_t value) { return m_builder ? m_builder->number_integer(value) : this->scalar(value); }
+		bool number_unsigned(nlohmann::json::number_unsigned_t value) { return m_builder ? m_builder->number_unsigned(value) : this->scalar(value); }
+		bool number_float(nlohmann::json::number_float_t value, std::string const& text) { return m_builder ? m_builder->number_float(value, text) : this->scalar(value); }
+		bool string(std::string& value) { return m_builder ? m_builder->string(value) : this->scalar(std::move(value)); }
+
+		bool key(std::string& name) {
+			if (m_builder) return m_builder->key(name);
+			if (nested()) return true;
+
+			m_field = skip;
+			if (name == "request_id") m_field = request_id;
+			else if (name == "inline_data") m_field = inline_data;
+			else for (size_t i = 0; i < std::size(P::json_fields); ++i) {
+				if (P::json_fields[i].name != name) continue;
+				m_field = static_cast<int>(i);
+				break;
+			}
+			return true;
+		}
+
+		bool start_object(size_t elements) {
+			if (m_depth == 0) { ++m_depth; return true; }
+			this->open();
+			return m_builder ? m_builder->start_object(elements) : true;
+		}
+		bool end_object() {
+			if (m_depth == 1) { --m_depth; return true; }
+			if (m_builder && !m_builder->end_object()) return false;
+			return this->close();
+		}
+		bool start_array(size_t elements) {
+			if (m_depth == 0) throw std::invalid_argument("Packet is not an object");
+			this->open();
+			return m_builder ? m_builder->start_array(elements) : true;
+		}
+		bool end_array() {
+			if (m_builder && !m_builder->end_array()) return false;
+			return this->close();
+		}
+		bool parse_error(size_t, std::string const&, nlohmann::json::exception const& ex) {
+			throw std::invalid_argument(ex.what());
+		}
+
+		void finish() const {
+			if (!m_hasRequestID) throw std::invalid_argument("Missing field request_id");
+			for (size_t i = 0; i < std::size(P::json_fields); ++i)
+				if (P::json_fields[i].required && !(m_seen & (uint64_t(1) << i)))
+					throw std::invalid_argument(std::format("Missing field {}", P::json_fields[i].name));
+		}
+	};
+
+	template<typename P>
+	void decode(std::string_view text, P& packet, Frame& frame) {
+		Reader<P> reader(packet, frame);
+		if (!nlohmann::json::sax_parse(text.data(), text.data() + text.size(), &reader))
+			throw std::invalid_argument("Malformed packet");
+		reader.finish();
+	}
+}
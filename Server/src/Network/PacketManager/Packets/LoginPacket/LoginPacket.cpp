@@ -5,75 +5,100 @@
 #include <bcrypt_.h>
 #include <print>
 
-void LoginPacket::handlePacket(Server &const server, class RemoteClient& client)
+void LoginPacket::handlePacket(class Server& server, class RemoteClient& client)
 {
 	try {
-		auto& db = server.getDatabase();
+		std::string hash;
+		std::string str_role;
+		int64_t userId = 0;
+		nlohmann::json additionalData = {};
+		{
+			auto db = server.getReader();
 
-		SQLite::Statement query(db, "SELECT * FROM Users WHERE email = ?");
+			auto& query = db.prepare("SELECT * FROM Users WHERE email = ?");
 
-		query.bind(1, m_login);
-		
+			query.bind(1, m_login);
 
-		if (!query.executeStep()) {
-			std::println("Invalid credentials for {}.", m_login);
-			ResponsePacket resp(ResponseID::LogErrInvalidData, "Invalid credentials", m_requestID);
-			client.sendData(resp);
-			return;
-		}
-		
-		int hashIndex = query.getColumnIndex("password_hash");
-		std::string hash = query.getColumn(hashIndex).getString();
+			if (!query.executeStep()) {
+				std::println("Invalid credentials for {}.", m_login);
+				ResponsePacket resp(ResponseID::LogErrInvalidData, "Invalid credentials", m_requestID);
+				client.sendData(resp);
+				return;
+			}
 
-		bool validate = bcrypt::validatePassword(m_password, hash);
+			int hashIndex = query.getColumnIndex("password_hash");
+			hash = query.getColumn(hashIndex).getString();
 
-		if (!validate) {
-			std::println("Invalid credentials for {}.", m_login);
-			ResponsePacket resp(ResponseID::LogErrInvalidData, "Invalid credentials", m_requestID);
-			client.sendData(resp);
-			return;
+			int roleIndex = query.getColumnIndex("role");
+			str_role = query.getColumn(roleIndex).getString();
+
+			int idIndex = query.getColumnIndex("id");
+			userId = query.getColumn(idIndex).getInt64();
+			additionalData["id"] = userId;
+			int nameIndex = query.getColumnIndex("first_name");
+			additionalData["name"] = query.getColumn(nameIndex).getString();
+			int surnameIndex = query.getColumnIndex("last_name");
+			additionalData["surname"] = query.getColumn(surnameIndex).getString();
+			additionalData["role"] = str_role;
 		}
 
-		int roleIndex = query.getColumnIndex("role");
-		auto str_role = query.getColumn(roleIndex).getString();
+		// bcrypt runs on the hash executor, the answer is sent from the client's strand
+		auto accepted = server.getHashExecutor().tryPost([
+			&server,
+			client = client.shared_from_this(),
+			login = m_login,
+			password = std::move(m_password),
+			hash = std::move(hash),
+			str_role = std::move(str_role),
+			additionalData = std::move(additionalData),
+			userId,
+			requestID = m_requestID
+		]() mutable {
+			bool validate = bcrypt::validatePassword(password, hash);
 
-		UserRole role = UserRole::GUEST;
+			auto strand = client->getStrand();
+			strand->post([&server, client = std::move(client), login = std::move(login), str_role = std::move(str_role),
+				additionalData = std::move(additionalData), userId, requestID, validate]() mutable {
+				if (!validate) {
+					std::println("Invalid credentials for {}.", login);
+					ResponsePacket resp(ResponseID::LogErrInvalidData, "Invalid credentials", requestID);
+					client->sendData(resp);
+					return;
+				}
 
-		if (str_role == "admin") {
-			role = UserRole::ADMIN;
-		}
+				UserRole role = UserRole::GUEST;
 
-		if (role != UserRole::ADMIN) {
-			std::println("Acess denied for: {} {}.", m_login, str_role);
-			ResponsePacket resp(ResponseID::AccessDenied, "Access denied", m_requestID);
-			client.sendData(resp);
-			return;
-		}
+				if (str_role == "admin") {
+					role = UserRole::ADMIN;
+				}
 
-		client.clientData.isLoggedIn = true;
-		client.clientData.login = m_login;
-		client.clientData.role = role;
+				if (role != UserRole::ADMIN) {
+					std::println("Acess denied for: {} {}.", login, str_role);
+					ResponsePacket resp(ResponseID::AccessDenied, "Access denied", requestID);
+					client->sendData(resp);
+					return;
+				}
 
-		int idIndex = query.getColumnIndex("id");
-		auto str_id = query.getColumn(idIndex).getInt64();
-		int nameIndex = query.getColumnIndex("first_name");
-		auto str_name = query.getColumn(nameIndex).getString();
-		int surnameIndex = query.getColumnIndex("last_name");
-		auto str_surname = query.getColumn(surnameIndex).getString();
+				// The client presents the token on reconnect instead of the password
+				auto token = server.getSessions().create(ClientData(true, login, role), userId, additionalData);
+				client->clientData = ClientData(true, login, role, token);
+				additionalData["session_token"] = std::move(token);
 
-		nlohmann::json additionalData = {};
-		additionalData["id"] = str_id;
-		additionalData["name"] = str_name;
-		additionalData["surname"] = str_surname;
-		additionalData["role"] = str_role;
+				ResponsePacket resp(ResponseID::Sucess, "", requestID, additionalData);
+				client->sendData(resp);
+				std::println("Login success for: {} {}.", login, str_role);
+			});
+		});
 
-		ResponsePacket resp(ResponseID::Sucess, "", m_requestID, additionalData);
-		client.sendData(resp);
-		std::println("Login success for: {} {}.", m_login, str_role);
+		if (!accepted) {
+			std::println("Login for {} rejected, hash queue is full.", m_login);
+			ResponsePacket resp(ResponseID::InternalError, "Server is busy, try again later", m_requestID);
+			client.sendData(resp);
+		}
 	}
 	catch (const std::exception& e) {
 		std::println(stderr, "Server error: {}", e.what());
 		ResponsePacket resp(ResponseID::InternalError, "Internal server error", m_requestID);
 		client.sendData(resp);
 	}
-}
\ No newline at end of file
+}
@@ -15,10 +15,14 @@ public:
 	PacketID getID() const override { return PacketID::Login; }
 	std::string getName() const override { return "LoginPacket"; }
 
+	static constexpr JsonField<LoginPacket> json_fields[] = {
+		{ "login",		[](LoginPacket& p, nlohmann::json& v) { p.m_login = JsonFields::take(v); } },
+		{ "password",	[](LoginPacket& p, nlohmann::json& v) { p.m_password = JsonFields::take(v); } },
+	};
+
 	void parse(nlohmann::json& data) override {
-		m_login = data["login"];
-		m_password = data["password"];
-		m_requestID = data["request_id"];
+		Packet::parse(data);
+		JsonFields::read(*this, data);
 	}
 
 	std::string toString() const override {
@@ -33,5 +37,15 @@ public:
 		json["password"] = m_password;
 		return json;
 	}
+
+	void writeFields(BinaryWriter& out) const override {
+		out.writeString(m_login);
+		out.writeString(m_password);
+	}
+
+	void readFields(BinaryReader& in) override {
+		m_login = in.readString();
+		m_password = in.readString();
+	}
 };
 
@@ -1,7 +1,11 @@
 #include "LogoutPacket.hpp"
 #include "../../../RemoteClient/RemoteClient.hpp"
+#include "../../../Server/Server.hpp"
 
 void LogoutPacket::handlePacket(class Server& server, class RemoteClient& client)
 {
+	if (!client.clientData.sessionToken.empty())
+		server.getSessions().revoke(client.clientData.sessionToken);
+	server.getChangeFeed().unsubscribeAll(client);
 	client.clientData = ClientData(false, "Anonymous", UserRole::GUEST);
 }
\ No newline at end of file
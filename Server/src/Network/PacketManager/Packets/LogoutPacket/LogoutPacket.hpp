@@ -1,6 +1,8 @@
 #pragma once
 #include "../Packet.hpp"
 
+#include <array>
+
 class LogoutPacket : public Packet
 {
 public:
@@ -11,5 +13,7 @@ public:
 
 	PacketID getID() const override { return PacketID::Logout; }
 	std::string getName() const override { return "LogoutPacket"; }
+
+	static constexpr std::array<JsonField<LogoutPacket>, 0> json_fields{};
 };
 
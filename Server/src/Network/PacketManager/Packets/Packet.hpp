@@ -1,6 +1,10 @@
 #pragma once
 #include "../PacketID.hpp"
 #include "../../../Utils/Json.hpp"
+#include "../../../Utils/BinaryStream.hpp"
+#include "../../Core/WireFormat.hpp"
+#include "../../Core/ClientData.hpp"
+#include "JsonFields.hpp"
 #include <string>
 
 class Packet
@@ -12,9 +16,16 @@ public:
 	Packet() = default;
 
 	virtual ~Packet() = default;
+	uint64_t getRequestID() const { return m_requestID; }
+	void setRequestID(uint64_t id) { m_requestID = id; }
 	virtual PacketID getID() const { return PacketID::Unknown; }
 	virtual std::string getName() const { return "Unknown"; }
 	virtual void handlePacket(class Server& server, class RemoteClient& client) { return; }
+	// Read-only packets get handleQuery() with a copy of the requester's
+	// ClientData instead. They run beside the client's strand, so several of
+	// them may be in flight and answer out of order, matched by request id
+	virtual bool isReadOnly() const { return false; }
+	virtual void handleQuery(class Server& server, class RemoteClient& client, ClientData const& requester) { }
 	virtual void parse(nlohmann::json& data) { 
 		m_requestID = data["request_id"];
 	}
@@ -27,5 +38,28 @@ public:
 		json["request_id"] = m_requestID;
 		return json;
 	}
+
+	// Binary encoding, see BinaryStream.hpp. Packets only (de)serialize their own fields
+	virtual void writeFields(BinaryWriter& out) const { }
+	virtual void readFields(BinaryReader& in) { }
+
+	std::string toBinary() const {
+		BinaryWriter out;
+		out.writeU8(BinaryStream::magic);
+		out.writeU8(static_cast<uint8_t>(this->getID()));
+		out.writeVarint(m_requestID);
+		this->writeFields(out);
+		return out.release();
+	}
+
+	// Frame payload in the given encoding, base64 wrapping of JSON is left to the transport
+	virtual std::string encode(WireFormat format) const {
+		return format == WireFormat::binary ? this->toBinary() : this->toString();
+	}
+
+	void parseBinary(BinaryReader& in) {
+		m_requestID = in.readVarint();
+		this->readFields(in);
+	}
 };	
 
@@ -0,0 +1,37 @@
+#pragma once
+#include "../../Server/Server.hpp"
+#include "ResponsePacket/ResponsePacket.hpp"
+
+#include <memory>
+#include <type_traits>
+
+// Hands a write packet to the server's WriteQueue. apply() runs in the next
+// group's transaction as the requester that sent it, afterCommit() and the
+// reply follow once that group committed. The packet is moved along, the
+// caller's copy is gone once its handler returns.
+// Off the client's strand the requester and the write ticket have to be
+// passed in, as they were when the packet was handled there. The ticket is
+// released with the reply, the client's queries behind the write wait for it.
+template<typename WritePacket>
+void queueWrite(class Server& server, class RemoteClient& client, ClientData requester, RemoteClient::WriteTicket ticket, WritePacket&& packet)
+{
+	auto self = std::make_shared<std::decay_t<WritePacket>>(std::move(packet));
+
+	server.getWriteQueue().submit({
+		[self, &server, requester = std::move(requester)](DatabasePool::Lease& db) {
+			return self->apply(server, requester, db);
+		},
+		[self, &server, client = client.shared_from_this(), ticket = std::move(ticket)](DatabasePool::Lease& db, WriteResult const& result) {
+			if (result) self->afterCommit(server, db, result);
+
+			ResponsePacket resp(result.code, result.message, self->getRequestID());
+			client->sendData(resp);
+		}
+	});
+}
+
+template<typename WritePacket>
+void queueWrite(class Server& server, class RemoteClient& client, WritePacket&& packet)
+{
+	queueWrite(server, client, client.clientData, client.beginWrite(), std::move(packet));
+}
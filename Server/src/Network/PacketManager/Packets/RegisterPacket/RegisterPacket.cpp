@@ -1,68 +1,107 @@
 #include "RegisterPacket.hpp"
 #include "../../../Server/Server.hpp"
 #include "../ResponsePacket/ResponsePacket.hpp"
+#include "../../../../Utils/Validators.hpp"
 
 #include <print>
-#include <regex>
 #include <bcrypt_.h>
 
 void RegisterPacket::handlePacket(class Server& server, class RemoteClient& client)
 {
 	try {
-		std::regex email_regex(R"(^[A-Za-z0-9._%+-]+@[A-Za-z0-9.-]+\.[A-Za-z]{2,}$)");
-		std::regex phone_regex(R"(^$|^\+?\d{10,15}$)");
-		std::regex password_regex(R"(^.{8,}$)");
-
-		if (!std::regex_match(m_login, email_regex)) {
+		if (!Validators::isEmail(m_login)) {
 			ResponsePacket resp(ResponseID::RegErrInvalidData, "Invalid email format", m_requestID);
 			client.sendData(resp);
 			return;
 		}
 
-		if (!std::regex_match(m_password, password_regex)) {
+		if (!Validators::isPassword(m_password)) {
 			ResponsePacket resp(ResponseID::RegErrInvalidData, "Password must be at least 8 characters", m_requestID);
 			client.sendData(resp);
 			return;
 		}
 
-		if (!std::regex_match(m_phoneNumber, phone_regex)) {
+		if (!Validators::isPhone(m_phoneNumber)) {
 			ResponsePacket resp(ResponseID::RegErrInvalidData, "Invalid phone number", m_requestID);
 			client.sendData(resp);
 			return;
 		}
 
-		auto& db = server.getDatabase();
+		{
+			// Cheap check up front, no hashing for an address that is taken
+			auto db = server.getReader();
 
-		auto query = SQLite::Statement(db, "SELECT * FROM Users WHERE email = ?");
+			auto& query = db.prepare("SELECT * FROM Users WHERE email = ?");
 
-		query.bind(1, m_login);
+			query.bind(1, m_login);
 
-		if (query.executeStep()) {
-			std::println("User {} already exists.", m_login);
-			ResponsePacket resp1(ResponseID::RegErrUserExists, "User already exists", m_requestID);
-			client.sendData(resp1);
-			return;
+			if (query.executeStep()) {
+				std::println("User {} already exists.", m_login);
+				ResponsePacket resp1(ResponseID::RegErrUserExists, "User already exists", m_requestID);
+				client.sendData(resp1);
+				return;
+			}
 		}
 
-		m_password = bcrypt::generateHash(m_password);
-		
-		auto query2 = SQLite::Statement(db, R"(
-			INSERT INTO Users (email, password_hash, first_name, last_name, phone_number)
-			VALUES (?, ?, ?, ?, ?)
-		)");
+		// bcrypt runs on the hash executor, the insert is queued for the writer from there
+		auto accepted = server.getHashExecutor().tryPost([
+			&server,
+			client = client.shared_from_this(),
+			ticket = client.beginWrite(),
+			login = m_login,
+			password = std::move(m_password),
+			name = m_name,
+			surname = m_surname,
+			phoneNumber = m_phoneNumber,
+			requestID = m_requestID
+		]() mutable {
+			auto hash = bcrypt::generateHash(password);
 
-		query2.bind(1, m_login);
-		query2.bind(2, m_password);
-		query2.bind(3, m_name);
-		query2.bind(4, m_surname);
-		query2.bind(5, m_phoneNumber);
+			server.getWriteQueue().submit({
+				[login, hash = std::move(hash), name = std::move(name), surname = std::move(surname),
+					phoneNumber = std::move(phoneNumber)](DatabasePool::Lease& db) -> WriteResult {
+					// Someone may have taken the address while the hash was computed
+					auto& query = db.prepare("SELECT * FROM Users WHERE email = ?");
 
-		query2.exec();
+					query.bind(1, login);
 
-		ResponsePacket resp(ResponseID::Sucess, "", m_requestID);
-		client.sendData(resp);
+					if (query.executeStep()) {
+						std::println("User {} already exists.", login);
+						return { ResponseID::RegErrUserExists, "User already exists" };
+					}
+
+					auto& query2 = db.prepare(R"(
+						INSERT INTO Users (email, password_hash, first_name, last_name, phone_number)
+						VALUES (?, ?, ?, ?, ?)
+					)");
+
+					query2.bind(1, login);
+					query2.bind(2, hash);
+					query2.bind(3, name);
+					query2.bind(4, surname);
+					query2.bind(5, phoneNumber);
 
-		std::println("User {} successfully registered.", m_login);
+					query2.exec();
+					return { ResponseID::Sucess, "", db->getLastInsertRowid() };
+				},
+				[&server, client = std::move(client), ticket = std::move(ticket), login, requestID](DatabasePool::Lease& db, WriteResult const& result) {
+					if (result) {
+						server.getResultCache().invalidate(TableID::USERS);
+						server.getChangeFeed().publishRow(db, TableID::USERS, RowChange::Added, result.rowID);
+						std::println("User {} successfully registered.", login);
+					}
+
+					ResponsePacket resp(result.code, result.message, requestID);
+					client->sendData(resp);
+				}
+			});
+		});
+
+		if (!accepted) {
+			std::println("Registration of {} rejected, hash queue is full.", m_login);
+			ResponsePacket resp(ResponseID::InternalError, "Server is busy, try again later", m_requestID);
+			client.sendData(resp);
+		}
 	}
 	catch (const std::exception& e) {
 		std::println(stderr, "Server error: {}", e.what());
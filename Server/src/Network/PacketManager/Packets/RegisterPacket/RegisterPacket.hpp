@@ -19,13 +19,17 @@ public:
 	PacketID getID() const override { return PacketID::Register; }
 	std::string getName() const override { return "RegisterPacket"; }
 
+	static constexpr JsonField<RegisterPacket> json_fields[] = {
+		{ "login",			[](RegisterPacket& p, nlohmann::json& v) { p.m_login = JsonFields::take(v); } },
+		{ "password",		[](RegisterPacket& p, nlohmann::json& v) { p.m_password = JsonFields::take(v); } },
+		{ "name",			[](RegisterPacket& p, nlohmann::json& v) { p.m_name = JsonFields::take(v); } },
+		{ "surname",		[](RegisterPacket& p, nlohmann::json& v) { p.m_surname = JsonFields::take(v); } },
+		{ "phone_number",	[](RegisterPacket& p, nlohmann::json& v) { p.m_phoneNumber = JsonFields::take(v); } },
+	};
+
 	void parse(nlohmann::json& data) override {
-		m_login = data["login"];
-		m_password = data["password"];
-		m_name = data["name"];
-		m_surname = data["surname"];
-		m_phoneNumber = data["phone_number"];
-		m_requestID = data["request_id"];
+		Packet::parse(data);
+		JsonFields::read(*this, data);
 	}
 
 	std::string toString() const override {
@@ -43,5 +47,21 @@ public:
 		json["phone_number"] = m_phoneNumber;
 		return json;
 	}
+
+	void writeFields(BinaryWriter& out) const override {
+		out.writeString(m_login);
+		out.writeString(m_password);
+		out.writeString(m_name);
+		out.writeString(m_surname);
+		out.writeString(m_phoneNumber);
+	}
+
+	void readFields(BinaryReader& in) override {
+		m_login = in.readString();
+		m_password = in.readString();
+		m_name = in.readString();
+		m_surname = in.readString();
+		m_phoneNumber = in.readString();
+	}
 };
 
@@ -1,6 +1,8 @@
 #pragma once
 #include "../Packet.hpp"
 
+#include <memory>
+
 enum class ResponseID
 {
 	Sucess = 0,
@@ -17,10 +19,20 @@ enum class ResponseID
 
 class ResponsePacket : public Packet
 {
+	// How additional_data is stored in the binary encoding
+	enum class DataEncoding : uint8_t {
+		msgpack = 0,
+		json_text = 1,
+	};
+
 private:
 	ResponseID		m_errorCode;
 	std::string		m_errorMessage;
 	nlohmann::json	m_additionalData;
+	// Already serialized JSON, spliced into the frame as is. Takes precedence over m_additionalData
+	std::shared_ptr<const std::string>	m_rawAdditionalData;
+	// Commit sequence of the table the data was read at, 0 when it is no table snapshot
+	uint64_t		m_sequence = 0;
 public:
 	ResponsePacket() = default;
 	ResponsePacket(ResponseID code, const std::string& msg, uint64_t requestID, nlohmann::json additionalData = nlohmann::json()) : m_errorCode(code), m_errorMessage(msg), m_additionalData(additionalData), Packet(requestID) {}
@@ -33,8 +45,16 @@ public:
 
 	virtual void parse(nlohmann::json& data) override {
 		m_errorCode = data["error_code"];
-		m_errorMessage = data["error_message"];
+		m_errorMessage = data["error_message"].get<std::string>();
 		m_requestID = data["request_id"];
+		m_sequence = data.value("sequence", uint64_t(0));
+
+		auto it = data.find("additional_data");
+		if (it != data.end() && !it->is_string()) {
+			m_additionalData = std::move(*it);
+			return;
+		}
+
 		try {
 			m_additionalData = nlohmann::json::parse(data.value("additional_data", "{}"));
 		}
@@ -53,9 +73,69 @@ public:
 		json["request_id"] = m_requestID;
 		json["error_code"] = m_errorCode;
 		json["error_message"] = m_errorMessage;
-		json["additional_data"] = m_additionalData.dump();
+		json["additional_data"] = this->additionalDataText();
+		json["wire"] = BinaryStream::version;
+		if (m_sequence) json["sequence"] = m_sequence;
 		return json;
 	}
 
+	virtual std::string encode(WireFormat format) const override {
+		if (format != WireFormat::json_inline)
+			return Packet::encode(format);
+
+		nlohmann::json json;
+		json["type"] = this->getID();
+		json["request_id"] = m_requestID;
+		json["error_code"] = m_errorCode;
+		json["error_message"] = m_errorMessage;
+		json["wire"] = BinaryStream::version;
+		json["inline_data"] = true;
+		if (m_sequence) json["sequence"] = m_sequence;
+
+		// Splice the payload in as a value instead of escaping it into a string
+		auto text = json.dump();
+		text.pop_back();
+		text += ",\"additional_data\":";
+		if (m_rawAdditionalData) text += *m_rawAdditionalData;
+		else text += m_additionalData.dump();
+		text += '}';
+		return text;
+	}
+
+	virtual void writeFields(BinaryWriter& out) const override {
+		out.writeVarint(static_cast<uint64_t>(m_errorCode));
+		out.writeString(m_errorMessage);
+		if (m_rawAdditionalData) {
+			out.writeU8(static_cast<uint8_t>(DataEncoding::json_text));
+			out.writeString(*m_rawAdditionalData);
+		}
+		else {
+			out.writeU8(static_cast<uint8_t>(DataEncoding::msgpack));
+			out.writeJson(m_additionalData);
+		}
+		// Trailing and optional, readers of an older version stop before it
+		if (m_sequence) out.writeVarint(m_sequence);
+	}
+
+	virtual void readFields(BinaryReader& in) override {
+		m_errorCode = static_cast<ResponseID>(in.readVarint());
+		m_errorMessage = in.readString();
+		if (static_cast<DataEncoding>(in.readU8()) == DataEncoding::json_text)
+			m_additionalData = nlohmann::json::parse(in.readStringView());
+		else
+			m_additionalData = in.readJson();
+		m_sequence = in.atEnd() ? 0 : in.readVarint();
+	}
+
+	void setRawAdditionalData(std::string json) { m_rawAdditionalData = std::make_shared<const std::string>(std::move(json)); }
+	// Shared text, e.g. from the ResultCache, is only copied into the frame itself
+	void setRawAdditionalData(std::shared_ptr<const std::string> json) { m_rawAdditionalData = std::move(json); }
+	void setSequence(uint64_t sequence) { m_sequence = sequence; }
+
+private:
+	std::string additionalDataText() const {
+		return m_rawAdditionalData ? *m_rawAdditionalData : m_additionalData.dump();
+	}
+
 };
 
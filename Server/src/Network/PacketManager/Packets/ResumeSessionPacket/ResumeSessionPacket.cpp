@@ -0,0 +1,30 @@
+#include "ResumeSessionPacket.hpp"
+#include "../../../Server/Server.hpp"
+#include "../ResponsePacket/ResponsePacket.hpp"
+
+#include <print>
+
+void ResumeSessionPacket::handlePacket(class Server& server, class RemoteClient& client)
+{
+	try {
+		auto session = server.getSessions().resume(m_token);
+
+		if (!session) {
+			ResponsePacket resp(ResponseID::LogErrInvalidData, "Session expired", m_requestID);
+			client.sendData(resp);
+			return;
+		}
+
+		client.clientData = std::move(session->data);
+		session->profile["session_token"] = m_token;
+
+		ResponsePacket resp(ResponseID::Sucess, "", m_requestID, std::move(session->profile));
+		client.sendData(resp);
+		std::println("Session resumed for: {}.", client.clientData.login);
+	}
+	catch (const std::exception& e) {
+		std::println(stderr, "Server error: {}", e.what());
+		ResponsePacket resp(ResponseID::InternalError, "Internal server error", m_requestID);
+		client.sendData(resp);
+	}
+}
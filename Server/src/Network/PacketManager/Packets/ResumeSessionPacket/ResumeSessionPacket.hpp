@@ -0,0 +1,47 @@
+#pragma once
+#include "../Packet.hpp"
+
+// Restores a logged in session by the token a LoginPacket response carried,
+// no password check involved
+class ResumeSessionPacket : public Packet
+{
+private:
+	std::string m_token;
+public:
+	ResumeSessionPacket() = default;
+	ResumeSessionPacket(nlohmann::json& data) { this->parse(data); }
+
+	void handlePacket(class Server& server, class RemoteClient& client) override;
+
+	PacketID getID() const override { return PacketID::ResumeSession; }
+	std::string getName() const override { return "ResumeSessionPacket"; }
+
+	static constexpr JsonField<ResumeSessionPacket> json_fields[] = {
+		{ "token", [](ResumeSessionPacket& p, nlohmann::json& v) { p.m_token = JsonFields::take(v); } },
+	};
+
+	void parse(nlohmann::json& data) override {
+		Packet::parse(data);
+		JsonFields::read(*this, data);
+	}
+
+	std::string toString() const override {
+		return this->toJSON().dump();
+	}
+
+	nlohmann::json toJSON() const override {
+		nlohmann::json json;
+		json["type"] = this->getID();
+		json["request_id"] = m_requestID;
+		json["token"] = m_token;
+		return json;
+	}
+
+	void writeFields(BinaryWriter& out) const override {
+		out.writeString(m_token);
+	}
+
+	void readFields(BinaryReader& in) override {
+		m_token = in.readString();
+	}
+};
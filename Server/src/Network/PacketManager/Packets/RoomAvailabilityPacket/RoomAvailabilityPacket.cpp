@@ -0,0 +1,43 @@
+#include "RoomAvailabilityPacket.hpp"
+#include "../../../Server/Server.hpp"
+#include "../ResponsePacket/ResponsePacket.hpp"
+
+#include <print>
+
+void RoomAvailabilityPacket::handleQuery(class Server& server, class RemoteClient& client, ClientData const& requester)
+{
+	try {
+		if (!requester.isLoggedIn) {
+			ResponsePacket resp(ResponseID::AccessDenied, "Access Denied", m_requestID);
+			client.sendData(resp);
+			return;
+		}
+
+		auto from = RoomAvailability::parseDate(m_checkIn);
+		auto to = RoomAvailability::parseDate(m_checkOut);
+		if (!from || !to || *from >= *to) {
+			ResponsePacket resp(ResponseID::InvalidTable, "Invalid query: bad date range", m_requestID);
+			client.sendData(resp);
+			return;
+		}
+
+		auto const& availability = server.getAvailability();
+
+		nlohmann::json result;
+		if (m_roomId != 0) {
+			result["room_id"] = m_roomId;
+			result["free"] = availability.isFree(m_roomId, *from, *to);
+		}
+		else {
+			result["rooms"] = availability.freeRooms(*from, *to, m_capacity);
+		}
+
+		ResponsePacket resp(ResponseID::Sucess, "", m_requestID, std::move(result));
+		client.sendData(resp);
+	}
+	catch (const std::exception& e) {
+		std::println(stderr, "Server error: {}", e.what());
+		ResponsePacket resp(ResponseID::InternalError, "Internal server error", m_requestID);
+		client.sendData(resp);
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "../Packet.hpp"
+
+// Availability answered from the in-memory RoomAvailability index. With a
+// room id: {"room_id": id, "free": bool} for that room, without one:
+// {"rooms": [ids]} of every room free over [m_checkIn, m_checkOut) holding
+// at least m_capacity guests.
+class RoomAvailabilityPacket : public Packet
+{
+private:
+	int64_t		m_roomId = 0;		// 0 - any room
+	std::string	m_checkIn;
+	std::string	m_checkOut;
+	uint32_t	m_capacity = 0;
+public:
+	RoomAvailabilityPacket() = default;
+	RoomAvailabilityPacket(nlohmann::json& data) { this->parse(data); }
+
+	bool isReadOnly() const override { return true; }
+	void handleQuery(class Server& server, class RemoteClient& client, ClientData const& requester) override;
+
+	PacketID getID() const override { return PacketID::RoomAvailability; }
+	std::string getName() const override { return "RoomAvailabilityPacket"; }
+
+	static constexpr JsonField<RoomAvailabilityPacket> json_fields[] = {
+		{ "room_id",	[](RoomAvailabilityPacket& p, nlohmann::json& v) { p.m_roomId = v.get<int64_t>(); }, false },
+		{ "check_in",	[](RoomAvailabilityPacket& p, nlohmann::json& v) { p.m_checkIn = JsonFields::take(v); } },
+		{ "check_out",	[](RoomAvailabilityPacket& p, nlohmann::json& v) { p.m_checkOut = JsonFields::take(v); } },
+		{ "capacity",	[](RoomAvailabilityPacket& p, nlohmann::json& v) { p.m_capacity = v.get<uint32_t>(); }, false },
+	};
+
+	void parse(nlohmann::json& data) override {
+		Packet::parse(data);
+		JsonFields::read(*this, data);
+	}
+
+	std::string toString() const override {
+		return this->toJSON().dump();
+	}
+
+	nlohmann::json toJSON() const override {
+		nlohmann::json json;
+		json["type"] = this->getID();
+		json["request_id"] = m_requestID;
+		json["room_id"] = m_roomId;
+		json["check_in"] = m_checkIn;
+		json["check_out"] = m_checkOut;
+		json["capacity"] = m_capacity;
+		return json;
+	}
+
+	void writeFields(BinaryWriter& out) const override {
+		out.writeSVarint(m_roomId);
+		out.writeString(m_checkIn);
+		out.writeString(m_checkOut);
+		out.writeVarint(m_capacity);
+	}
+
+	void readFields(BinaryReader& in) override {
+		m_roomId = in.readSVarint();
+		m_checkIn = in.readString();
+		m_checkOut = in.readString();
+		m_capacity = static_cast<uint32_t>(in.readVarint());
+	}
+};
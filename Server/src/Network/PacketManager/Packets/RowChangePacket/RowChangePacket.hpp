@@ -0,0 +1,78 @@
+#pragma once
+#include "../Packet.hpp"
+#include "../../../Core/DatabaseSchema.hpp"
+
+enum class RowChange : uint8_t {
+	Added,
+	Edited,
+	Deleted,
+};
+
+// Pushed by the server to subscribers of a table after a write committed,
+// it answers no request and carries request id 0. m_row holds the columns
+// GetData would return, except the ones no query may see, and stays empty
+// for a deleted row. m_sequence is the table's commit sequence, set by the
+// ChangeFeed when it is published; GetData answers carry the same counter.
+class RowChangePacket : public Packet
+{
+private:
+	TableID			m_table;
+	RowChange		m_change;
+	int64_t			m_rowID;
+	nlohmann::json	m_row;
+	uint64_t		m_sequence = 0;
+public:
+	RowChangePacket() = default;
+	RowChangePacket(TableID table, RowChange change, int64_t rowID, nlohmann::json row = nlohmann::json::object())
+		: Packet(0), m_table(table), m_change(change), m_rowID(rowID), m_row(std::move(row)) { }
+	RowChangePacket(nlohmann::json& data) { this->parse(data); }
+
+	// Only ever sent by the server
+	void handlePacket(class Server& server, class RemoteClient& client) override { }
+
+	PacketID getID() const override { return PacketID::RowChange; }
+	std::string getName() const override { return "RowChangePacket"; }
+
+	void parse(nlohmann::json& data) override {
+		m_table = data["table_id"];
+		m_change = data["change"];
+		m_rowID = data["row_id"];
+		m_row = data.value("row", nlohmann::json::object());
+		m_requestID = data["request_id"];
+		m_sequence = data.value("sequence", uint64_t(0));
+	}
+
+	std::string toString() const override {
+		return this->toJSON().dump();
+	}
+
+	nlohmann::json toJSON() const override {
+		nlohmann::json json;
+		json["type"] = this->getID();
+		json["request_id"] = m_requestID;
+		json["table_id"] = m_table;
+		json["change"] = m_change;
+		json["row_id"] = m_rowID;
+		json["row"] = m_row;
+		json["sequence"] = m_sequence;
+		return json;
+	}
+
+	void writeFields(BinaryWriter& out) const override {
+		out.writeVarint(static_cast<uint64_t>(m_table));
+		out.writeU8(static_cast<uint8_t>(m_change));
+		out.writeSVarint(m_rowID);
+		out.writeJson(m_row);
+		out.writeVarint(m_sequence);
+	}
+
+	void readFields(BinaryReader& in) override {
+		m_table = static_cast<TableID>(in.readVarint());
+		m_change = static_cast<RowChange>(in.readU8());
+		m_rowID = in.readSVarint();
+		m_row = in.readJson();
+		m_sequence = in.atEnd() ? 0 : in.readVarint();
+	}
+
+	void setSequence(uint64_t sequence) { m_sequence = sequence; }
+};
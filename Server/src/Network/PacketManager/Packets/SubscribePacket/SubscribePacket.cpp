@@ -0,0 +1,38 @@
+#include "SubscribePacket.hpp"
+#include "../../../Server/Server.hpp"
+#include "../ResponsePacket/ResponsePacket.hpp"
+
+#include <print>
+
+void SubscribePacket::handlePacket(class Server& server, class RemoteClient& client)
+{
+	try {
+		// Deltas carry whole rows, the same data GetData is limited to
+		if (client.clientData.role != UserRole::ADMIN) {
+			ResponsePacket resp(ResponseID::AccessDenied, "Access Denied", m_requestID);
+			client.sendData(resp);
+			return;
+		}
+
+		auto const& table = tableSchema(m_table);
+
+		if (m_subscribe)
+			server.getChangeFeed().subscribe(m_table, client.shared_from_this());
+		else
+			server.getChangeFeed().unsubscribe(m_table, client);
+
+		std::println("{} {} {}.", client.getFullIP(), m_subscribe ? "subscribed to" : "unsubscribed from", table.name);
+
+		ResponsePacket resp(ResponseID::Sucess, "", m_requestID);
+		client.sendData(resp);
+	}
+	catch (const std::out_of_range&) {
+		ResponsePacket resp(ResponseID::InvalidTable, "Invalid table", m_requestID);
+		client.sendData(resp);
+	}
+	catch (const std::exception& e) {
+		std::println(stderr, "Server error: {}", e.what());
+		ResponsePacket resp(ResponseID::InternalError, "Internal server error", m_requestID);
+		client.sendData(resp);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "../Packet.hpp"
+#include "../../../Core/DatabaseSchema.hpp"
+
+// Starts or stops the RowChangePackets of one table for this connection.
+// Subscriptions live as long as the connection, logging out drops them.
+class SubscribePacket : public Packet
+{
+private:
+	TableID	m_table;
+	bool	m_subscribe = true;
+public:
+	SubscribePacket() = default;
+	SubscribePacket(nlohmann::json& data) { this->parse(data); }
+
+	void handlePacket(class Server& server, class RemoteClient& client) override;
+
+	PacketID getID() const override { return PacketID::Subscribe; }
+	std::string getName() const override { return "SubscribePacket"; }
+
+	static constexpr JsonField<SubscribePacket> json_fields[] = {
+		{ "table_id",	[](SubscribePacket& p, nlohmann::json& v) { p.m_table = v.get<TableID>(); } },
+		{ "subscribe",	[](SubscribePacket& p, nlohmann::json& v) { p.m_subscribe = v.get<bool>(); }, false },
+	};
+
+	void parse(nlohmann::json& data) override {
+		Packet::parse(data);
+		JsonFields::read(*this, data);
+	}
+
+	std::string toString() const override {
+		return this->toJSON().dump();
+	}
+
+	nlohmann::json toJSON() const override {
+		nlohmann::json json;
+		json["type"] = this->getID();
+		json["request_id"] = m_requestID;
+		json["table_id"] = m_table;
+		json["subscribe"] = m_subscribe;
+		return json;
+	}
+
+	void writeFields(BinaryWriter& out) const override {
+		out.writeVarint(static_cast<uint64_t>(m_table));
+		out.writeU8(m_subscribe);
+	}
+
+	void readFields(BinaryReader& in) override {
+		m_table = static_cast<TableID>(in.readVarint());
+		m_subscribe = in.readU8() != 0;
+	}
+};
@@ -0,0 +1,15 @@
+#pragma once
+#include "ResponsePacket/ResponsePacket.hpp"
+
+#include <stdint.h>
+#include <string>
+
+// Outcome of a data write before anything is sent, the response code and
+// message as the handler would reply them. rowID is the row written.
+struct WriteResult {
+	ResponseID	code = ResponseID::Sucess;
+	std::string	message;
+	int64_t		rowID = 0;
+
+	explicit operator bool() const { return code == ResponseID::Sucess; }
+};
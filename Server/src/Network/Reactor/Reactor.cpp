@@ -0,0 +1,238 @@
+#include "Reactor.hpp"
+
+#include <print>
+
+#ifdef _WIN32
+
+Reactor::Reactor() : m_wake_socket(INVALID_SOCKET), m_wake_address{}
+{
+}
+
+bool Reactor::open()
+{
+    if (this->isOpen()) return true;
+
+    // WSAPoll can't be interrupted, so wakeup() pokes a loopback datagram socket
+    // that is always part of the polled set.
+    m_wake_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (m_wake_socket == INVALID_SOCKET) {
+        std::println(stderr, "Reactor: can't create wake socket, err: {}", WSAGetLastError());
+        return false;
+    }
+
+    m_wake_address.sin_family = AF_INET;
+    m_wake_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    m_wake_address.sin_port = 0;
+
+    int addrlen = sizeof(m_wake_address);
+    if (bind(m_wake_socket, reinterpret_cast<sockaddr*>(&m_wake_address), sizeof(m_wake_address)) == SOCKET_ERROR ||
+        getsockname(m_wake_socket, reinterpret_cast<sockaddr*>(&m_wake_address), &addrlen) == SOCKET_ERROR) {
+        std::println(stderr, "Reactor: can't bind wake socket, err: {}", WSAGetLastError());
+        closesocket(m_wake_socket);
+        m_wake_socket = INVALID_SOCKET;
+        return false;
+    }
+
+    u_long mode = 1;
+    ioctlsocket(m_wake_socket, FIONBIO, &mode);
+    return true;
+}
+
+bool Reactor::isOpen() const
+{
+    return m_wake_socket != INVALID_SOCKET;
+}
+
+Reactor::~Reactor()
+{
+    if (m_wake_socket != INVALID_SOCKET)
+        closesocket(m_wake_socket);
+}
+
+bool Reactor::add(SOCKET socket, uint64_t key, uint32_t interest)
+{
+    {
+        std::lock_guard lock(m_reg_mtx);
+        if (!m_registrations.try_emplace(socket, Registration{ key, interest, true }).second)
+            return false;
+    }
+    this->wakeup();
+    return true;
+}
+
+bool Reactor::rearm(SOCKET socket, uint64_t key, uint32_t interest)
+{
+    {
+        std::lock_guard lock(m_reg_mtx);
+        auto it = m_registrations.find(socket);
+        if (it == m_registrations.end()) return false;
+        it->second = Registration{ key, interest, true };
+    }
+    this->wakeup();
+    return true;
+}
+
+void Reactor::remove(SOCKET socket)
+{
+    std::lock_guard lock(m_reg_mtx);
+    m_registrations.erase(socket);
+}
+
+size_t Reactor::wait(std::vector<ReactorEventData>& events, int timeout_ms)
+{
+    events.clear();
+
+    std::vector<WSAPOLLFD> fds;
+    {
+        std::lock_guard lock(m_reg_mtx);
+        fds.reserve(m_registrations.size() + 1);
+        fds.push_back({ m_wake_socket, POLLRDNORM, 0 });
+        for (const auto& [socket, reg] : m_registrations) {
+            if (!reg.armed) continue;
+            SHORT poll_events = 0;
+            if (reg.interest & EV_READ) poll_events |= POLLRDNORM;
+            if (reg.interest & EV_WRITE) poll_events |= POLLWRNORM;
+            fds.push_back({ socket, poll_events, 0 });
+        }
+    }
+
+    int ready = WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), timeout_ms);
+    if (ready <= 0) return 0;
+
+    if (fds[0].revents) {
+        char buffer[64];
+        while (recv(m_wake_socket, buffer, sizeof(buffer), 0) > 0);
+    }
+
+    std::lock_guard lock(m_reg_mtx);
+    for (size_t i = 1; i < fds.size(); ++i) {
+        if (!fds[i].revents) continue;
+
+        auto it = m_registrations.find(fds[i].fd);
+        if (it == m_registrations.end() || !it->second.armed) continue;
+        it->second.armed = false;
+
+        uint32_t ev = 0;
+        if (fds[i].revents & POLLRDNORM) ev |= EV_READ;
+        if (fds[i].revents & POLLWRNORM) ev |= EV_WRITE;
+        if (fds[i].revents & (POLLHUP | POLLERR | POLLNVAL)) ev |= EV_CLOSE | EV_READ;
+        events.push_back({ it->second.key, ev });
+    }
+
+    return events.size();
+}
+
+void Reactor::wakeup()
+{
+    if (m_wake_socket == INVALID_SOCKET) return;
+    char byte = 0;
+    sendto(m_wake_socket, &byte, sizeof(byte), 0, reinterpret_cast<const sockaddr*>(&m_wake_address), sizeof(m_wake_address));
+}
+
+#else
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+static uint32_t toEpollEvents(uint32_t interest)
+{
+    uint32_t ev = EPOLLONESHOT | EPOLLRDHUP;
+    if (interest & EV_READ) ev |= EPOLLIN;
+    if (interest & EV_WRITE) ev |= EPOLLOUT;
+    return ev;
+}
+
+Reactor::Reactor() : m_epoll_fd(-1), m_wake_fd(-1)
+{
+}
+
+bool Reactor::open()
+{
+    if (this->isOpen()) return true;
+
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epoll_fd == -1) {
+        std::println(stderr, "Reactor: epoll_create1 failed: {}", strerror(errno));
+        return false;
+    }
+
+    m_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_wake_fd == -1) {
+        std::println(stderr, "Reactor: eventfd failed: {}", strerror(errno));
+        close(m_epoll_fd);
+        m_epoll_fd = -1;
+        return false;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = wake_key;
+    return epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_wake_fd, &ev) == 0;
+}
+
+bool Reactor::isOpen() const
+{
+    return m_wake_fd != -1;
+}
+
+Reactor::~Reactor()
+{
+    if (m_wake_fd != -1) close(m_wake_fd);
+    if (m_epoll_fd != -1) close(m_epoll_fd);
+}
+
+bool Reactor::add(SOCKET socket, uint64_t key, uint32_t interest)
+{
+    epoll_event ev{};
+    ev.events = toEpollEvents(interest);
+    ev.data.u64 = key;
+    return epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, socket, &ev) == 0;
+}
+
+bool Reactor::rearm(SOCKET socket, uint64_t key, uint32_t interest)
+{
+    epoll_event ev{};
+    ev.events = toEpollEvents(interest);
+    ev.data.u64 = key;
+    return epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, socket, &ev) == 0;
+}
+
+void Reactor::remove(SOCKET socket)
+{
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, socket, nullptr);
+}
+
+size_t Reactor::wait(std::vector<ReactorEventData>& events, int timeout_ms)
+{
+    events.clear();
+
+    epoll_event ready[64];
+    int count = epoll_wait(m_epoll_fd, ready, static_cast<int>(std::size(ready)), timeout_ms);
+    if (count <= 0) return 0;
+
+    for (int i = 0; i < count; ++i) {
+        if (ready[i].data.u64 == wake_key) {
+            uint64_t value;
+            while (read(m_wake_fd, &value, sizeof(value)) > 0);
+            continue;
+        }
+
+        uint32_t ev = 0;
+        if (ready[i].events & EPOLLIN) ev |= EV_READ;
+        if (ready[i].events & EPOLLOUT) ev |= EV_WRITE;
+        if (ready[i].events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR)) ev |= EV_CLOSE | EV_READ;
+        events.push_back({ ready[i].data.u64, ev });
+    }
+
+    return events.size();
+}
+
+void Reactor::wakeup()
+{
+    uint64_t value = 1;
+    [[maybe_unused]] auto written = write(m_wake_fd, &value, sizeof(value));
+}
+
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+
+#include "../Socket/Socket.hpp"
+
+#ifndef _WIN32
+#include <sys/epoll.h>
+#endif
+
+enum ReactorEvent : uint32_t {
+	EV_READ		= 1 << 0,
+	EV_WRITE	= 1 << 1,
+	EV_CLOSE	= 1 << 2,
+};
+
+struct ReactorEventData {
+	uint64_t key;
+	uint32_t events;
+};
+
+// Readiness notifier for sockets. Every registration is one-shot: once an
+// event for a socket has been reported it stays disarmed until rearm(), so
+// only one worker at a time handles a given connection.
+class Reactor
+{
+private:
+#ifdef _WIN32
+	struct Registration {
+		uint64_t key;
+		uint32_t interest;
+		bool	 armed;
+	};
+
+	std::unordered_map<SOCKET, Registration>	m_registrations;
+	std::mutex									m_reg_mtx;
+	SOCKET										m_wake_socket;
+	SOCKADDR_IN									m_wake_address;
+#else
+	int											m_epoll_fd;
+	int											m_wake_fd;
+#endif
+
+public:
+	static constexpr uint64_t wake_key = UINT64_MAX;
+
+	Reactor();
+	~Reactor();
+
+	Reactor(const Reactor&) = delete;
+	Reactor& operator=(const Reactor&) = delete;
+
+	// Creates the OS handles. Kept out of the constructor so the owner can
+	// bring the socket library up first.
+	bool open();
+	bool isOpen() const;
+
+	bool add(SOCKET socket, uint64_t key, uint32_t interest);
+	bool rearm(SOCKET socket, uint64_t key, uint32_t interest);
+	void remove(SOCKET socket);
+
+	// Blocks until at least one registered socket is ready, wakeup() is called
+	// or timeout_ms elapses (-1 waits forever). Returns the number of events.
+	size_t wait(std::vector<ReactorEventData>& events, int timeout_ms = -1);
+	void wakeup();
+};
@@ -2,9 +2,10 @@
 #include "../../Utils/base64.hpp"
 #include "../PacketManager/PacketManager.hpp"
 #include <iostream>
-#include <WS2tcpip.h>
 #include <string>
 #include <print>
+#include <climits>
+#include <algorithm>
 
 std::string RemoteClient::getFullIP() const {
     char buffer[256];
@@ -15,94 +16,199 @@ std::string RemoteClient::getFullIP() const {
     return str;
 }
 
-void RemoteClient::handleSSLError(int result)
+bool RemoteClient::handleSSLError(int result)
 {
     int err = SSL_get_error(m_ssl, result);
     switch (err) {
-    case SSL_ERROR_ZERO_RETURN:
-        this->disconnect();
-
     case SSL_ERROR_WANT_READ:
+        m_want_write = false;
+        return true;
     case SSL_ERROR_WANT_WRITE:
+        m_want_write = true;
+        return true;
+    case SSL_ERROR_ZERO_RETURN:
+        this->closeLocked();
+        return false;
     case SSL_ERROR_SYSCALL:
-        break;
     case SSL_ERROR_SSL:
         ERR_print_errors_fp(stderr);
-        this->disconnect();
-        break;
+        this->closeLocked();
+        return false;
     default:
         std::println(stderr, "Unknown SSL error: {}", err);
-        this->disconnect();
+        this->closeLocked();
+        return false;
     }
 }
 
-std::vector<uint8_t> RemoteClient::receiveData() {
-    std::vector<uint8_t> buffer;
-    if (!m_ssl) return buffer;
+bool RemoteClient::doHandshake()
+{
+    std::lock_guard lock(m_ssl_mtx);
+    if (!m_ssl) return false;
 
-    if (u_long t = true; SOCKET_ERROR == ioctlsocket(m_socket, FIONBIO, &t)) return {};
+    ERR_clear_error();
+    int ret = SSL_do_handshake(m_ssl);
+    if (ret == 1) {
+        m_handshake_done = true;
+        m_want_write = false;
+        m_last_activity = std::chrono::steady_clock::now().time_since_epoch().count();
+        return true;
+    }
 
-    uint32_t size = 0;
-    int read_bytes = SSL_read(m_ssl, &size, sizeof(size));
+    handleSSLError(ret);
+    return false;
+}
 
-    if (u_long t = false; SOCKET_ERROR == ioctlsocket(m_socket, FIONBIO, &t)) return {};
+bool RemoteClient::receiveData(std::vector<std::vector<uint8_t>>& frames) {
+    // Upper bound of plaintext consumed per call, a flooding peer yields the
+    // worker back to the pool instead of keeping it forever
+    constexpr size_t read_budget = 256 * 1024;
+    constexpr size_t read_chunk = 16 * 1024;
 
-    if (read_bytes <= 0) {
-        handleSSLError(read_bytes);
-        return buffer;
-    }
+    std::lock_guard lock(m_ssl_mtx);
+    if (!m_ssl) return false;
+
+    size_t consumed = 0;
+    bool budget_exhausted = false;
 
-    if (size == 0 || size > 10 * 1024 * 1024)
-        return buffer;
+    while (true) {
+        if (consumed >= read_budget) {
+            budget_exhausted = true;
+            break;
+        }
 
-    buffer.resize(size);
-    size_t received = 0;
+        auto tail = m_frames.prepare(read_chunk);
 
-    while (received < size) {
-        int ret = SSL_read(m_ssl, buffer.data() + received, static_cast<int>(size - received));
+        ERR_clear_error();
+        int ret = SSL_read(m_ssl, tail.data(), static_cast<int>(tail.size()));
         if (ret <= 0) {
-            handleSSLError(read_bytes);
-            return {};
+            handleSSLError(ret);
+            break;
         }
-        received += ret;
+
+        m_frames.commit(ret);
+        consumed += ret;
     }
 
-    return buffer;
+    if (consumed != 0)
+        m_last_activity = std::chrono::steady_clock::now().time_since_epoch().count();
+
+    std::vector<uint8_t> frame;
+    while (true) {
+        auto result = m_frames.next(frame);
+        if (result == FrameAssembler::Result::incomplete) break;
+        if (result == FrameAssembler::Result::error) {
+            std::println(stderr, "Invalid frame size from {}", this->getFullIP());
+            this->closeLocked();
+            return false;
+        }
+        frames.push_back(std::move(frame));
+    }
+
+    return budget_exhausted && m_ssl;
 }
 
-bool RemoteClient::sendData(class Packet const& packet) const
+bool RemoteClient::sendData(class Packet const& packet)
 {
-    auto rawData = base64::to_base64(packet.toString());
-    return this->sendData(rawData.c_str(), rawData.size());
+    auto format = m_wire_format.load();
+    auto rawData = packet.encode(format);
+    if (format != WireFormat::binary)
+        rawData = base64::to_base64(rawData);
+    return this->sendData(rawData.data(), rawData.size());
 }
 
-bool RemoteClient::sendData(const void* buffer, size_t size) const {
-    if (!m_ssl || size == 0) return false;
+bool RemoteClient::sendData(const void* buffer, size_t size) {
+    if (size == 0 || this->getStatus() != SocketStatus::connected) return false;
 
     uint32_t len = static_cast<uint32_t>(size);
-    uint8_t header[sizeof(len)];
-    memcpy(header, &len, sizeof(len));
-
-    int ret = SSL_write(m_ssl, header, sizeof(len));
-    if (ret <= 0) {
-        ERR_print_errors_fp(stderr);
-        const_cast<RemoteClient*>(this)->disconnect();
+    if (m_pending_bytes.fetch_add(sizeof(len) + size) + sizeof(len) + size > max_pending_bytes) {
+        std::println(stderr, "Send queue overflow for {}", this->getFullIP());
+        this->disconnect();
         return false;
     }
 
-    ret = SSL_write(m_ssl, buffer, static_cast<int>(size));
-    if (ret <= 0) {
-        ERR_print_errors_fp(stderr);
-        const_cast<RemoteClient*>(this)->disconnect();
-        return false;
+    {
+        // Header and payload go out in one buffer, so one record instead of two
+        std::lock_guard lock(m_send_mtx);
+        auto bytes = static_cast<const uint8_t*>(buffer);
+        m_outbox.insert(m_outbox.end(), reinterpret_cast<const uint8_t*>(&len), reinterpret_cast<const uint8_t*>(&len) + sizeof(len));
+        m_outbox.insert(m_outbox.end(), bytes, bytes + size);
+    }
+
+    return this->flush();
+}
+
+bool RemoteClient::flush() {
+    bool ok;
+    {
+        std::lock_guard lock(m_ssl_mtx);
+        ok = this->flushLocked();
     }
 
+    // The socket is full, the reactor tells us when it drains
+    if (ok && this->hasPendingOutput())
+        this->requestWrite();
+    return ok;
+}
+
+bool RemoteClient::flushLocked() {
+    while (m_ssl) {
+        if (m_inflight_offset == m_inflight.size()) {
+            m_inflight.clear();
+            m_inflight_offset = 0;
+
+            // Everything queued while the previous batch was written goes out together
+            std::lock_guard lock(m_send_mtx);
+            if (m_outbox.empty()) return true;
+            std::swap(m_inflight, m_outbox);
+        }
+
+        auto left = std::min<size_t>(m_inflight.size() - m_inflight_offset, INT_MAX);
+
+        ERR_clear_error();
+        int ret = SSL_write(m_ssl, m_inflight.data() + m_inflight_offset, static_cast<int>(left));
+        if (ret > 0) {
+            m_inflight_offset += ret;
+            m_pending_bytes -= ret;
+            continue;
+        }
+
+        return this->handleSSLError(ret);
+    }
+
+    return false;
+}
+
+void RemoteClient::requestWrite() {
+    std::lock_guard lock(m_arm_mtx);
+    // A running event job re-arms with the write interest itself when it finishes
+    if (m_dispatched || !m_reactor || this->getStatus() != SocketStatus::connected) return;
+    m_reactor->rearm(m_socket, this->getKey().value(), this->getPollInterest());
+}
+
+bool RemoteClient::tryDispatch() {
+    std::lock_guard lock(m_arm_mtx);
+    if (m_dispatched) return false;
+    m_dispatched = true;
     return true;
 }
 
+void RemoteClient::rearm() {
+    std::lock_guard lock(m_arm_mtx);
+    m_dispatched = false;
+    if (m_reactor && this->getStatus() == SocketStatus::connected)
+        m_reactor->rearm(m_socket, this->getKey().value(), this->getPollInterest());
+}
+
 SocketStatus RemoteClient::disconnect() noexcept {
-    if (this->m_status != SocketStatus::connected)
-        return this->m_status;
+    std::lock_guard lock(m_ssl_mtx);
+    this->closeLocked();
+    return this->getStatus();
+}
+
+void RemoteClient::closeLocked() noexcept {
+    if (this->getStatus() != SocketStatus::connected)
+        return;
 
     if (m_ssl) {
         SSL_shutdown(m_ssl);
@@ -110,13 +216,19 @@ SocketStatus RemoteClient::disconnect() noexcept {
         m_ssl = nullptr;
     }
 
-    if (m_socket != INVALID_SOCKET) {
-        shutdown(m_socket, SD_BOTH);
-        closesocket(m_socket);
-        m_socket = INVALID_SOCKET;
+    {
+        std::lock_guard lock(m_send_mtx);
+        m_outbox.clear();
     }
+    m_inflight.clear();
+    m_inflight_offset = 0;
+    m_pending_bytes = 0;
+
+    // The descriptor itself stays open until the reactor has dropped it, see ~RemoteClient
+    if (m_socket != INVALID_SOCKET)
+        shutdown(m_socket, SD_BOTH);
 
-    return this->m_status = SocketStatus::disconnected;
+    this->m_status.store(SocketStatus::disconnected, std::memory_order_release);
 }
 
 void RemoteClient::onConnect()
@@ -127,4 +239,30 @@ void RemoteClient::onConnect()
 void RemoteClient::onDisconnect()
 {
     std::println("Client {} disconnected", this->getFullIP());
+}
+
+RemoteClient::WriteTicket RemoteClient::beginWrite() {
+    {
+        std::lock_guard lock(m_order_mtx);
+        ++m_pending_writes;
+    }
+    // Nothing is owned, the deleter alone marks the end of the write
+    return WriteTicket(nullptr, [self = shared_from_this()](void*) { self->endWrite(); });
+}
+
+void RemoteClient::endWrite() {
+    // Posted under the lock so that a query arriving now lines up behind these
+    std::lock_guard lock(m_order_mtx);
+    if (--m_pending_writes != 0) return;
+    for (auto& query : m_held_queries)
+        m_queries->post(std::move(query));
+    m_held_queries.clear();
+}
+
+void RemoteClient::postQuery(Task&& query) {
+    std::lock_guard lock(m_order_mtx);
+    if (m_pending_writes != 0)
+        m_held_queries.push_back(std::move(query));
+    else
+        m_queries->post(std::move(query));
 }
\ No newline at end of file
@@ -3,55 +3,136 @@
 #include <openssl/err.h>
 #include <stdint.h>
 #include <mutex>
-#include <WinSock2.h>
+#include <atomic>
+#include <chrono>
 #include <vector>
+#include <memory>
 
+#include "../Socket/Socket.hpp"
 #include "../Core/SocketStatus.hpp"
 #include "../Core/ClientData.hpp"
+#include "../Core/ClientKey.hpp"
+#include "../Core/FrameAssembler.hpp"
+#include "../Core/WireFormat.hpp"
+#include "../Reactor/Reactor.hpp"
+#include "../../Utils/ThreadPool/Strand.hpp"
+#include "../../Utils/ThreadPool/ConcurrencyLimiter.hpp"
 
-class RemoteClient
+class RemoteClient : public std::enable_shared_from_this<RemoteClient>
 {
 	friend class Server;
 private:
-	std::mutex			m_access_mtx;
+	std::mutex			m_ssl_mtx;
 	SOCKADDR_IN			m_address;
 	SOCKET				m_socket;
-	SocketStatus		m_status;
+	// Written under m_ssl_mtx by closeLocked(), read from any thread
+	std::atomic<SocketStatus> m_status;
 	SSL*				m_ssl;		
+	// Set by doHandshake() under m_ssl_mtx, read by the idle timer without it
+	std::atomic_bool	m_handshake_done;
+	// Set by handleSSLError() under m_ssl_mtx, read by getPollInterest() under m_arm_mtx
+	std::atomic_bool	m_want_write;
+	FrameAssembler		m_frames;
+	std::atomic<std::chrono::steady_clock::rep> m_last_activity;
+	// Replies use the encoding of the client's latest request
+	std::atomic<WireFormat> m_wire_format;
+
+	// Outgoing frames are appended to m_outbox, the flusher swaps it into
+	// m_inflight and writes it out in as few TLS records as possible
+	std::mutex			m_send_mtx;
+	std::vector<uint8_t> m_outbox;
+	std::vector<uint8_t> m_inflight;
+	size_t				m_inflight_offset;
+	std::atomic_size_t	m_pending_bytes;
+
+	// m_dispatched is set while an event job owns the connection, only the
+	// owner re-arms the reactor then. Guarded by m_arm_mtx
+	std::mutex			m_arm_mtx;
+	Reactor*			m_reactor;
+	bool				m_dispatched;
+
+	// Packets of one client are handled in order, one at a time. Read-only
+	// ones are decoded there and then handed to m_queries, which runs a
+	// bounded number of them at once
+	std::shared_ptr<Strand> m_strand;
+	std::shared_ptr<ConcurrencyLimiter> m_queries;
+
+	// Writes handed off and not answered yet. Queries arriving meanwhile are
+	// held back in m_held_queries, a read never overtakes the client's own
+	// earlier write. Guarded by m_order_mtx
+	std::mutex			m_order_mtx;
+	size_t				m_pending_writes;
+	std::vector<Task>	m_held_queries;
 
 public:
+	// A peer that stops reading gets dropped instead of growing the outbox forever
+	static constexpr size_t max_pending_bytes = 32 * 1024 * 1024;
+
 	std::atomic_bool	isDisconnecting;
 	ClientData			clientData;
 
 public:
 	RemoteClient() = default;
-	RemoteClient(SOCKET socket, SOCKADDR_IN address, SSL* ssl) : m_address(address), m_socket(socket), 
-		m_status(SocketStatus::connected), m_ssl(ssl), clientData(ClientData(false, "Anonymous", UserRole::GUEST)) {
+	RemoteClient(SOCKET socket, SOCKADDR_IN address, SSL* ssl, bool handshake_done = true) : m_address(address), m_socket(socket), 
+		m_status(SocketStatus::connected), m_ssl(ssl), m_handshake_done(handshake_done), m_want_write(false),
+		m_last_activity(std::chrono::steady_clock::now().time_since_epoch().count()), m_wire_format(WireFormat::json),
+		m_inflight_offset(0), m_pending_bytes(0), m_reactor(nullptr), m_dispatched(false), m_pending_writes(0),
+		clientData(ClientData(false, "Anonymous", UserRole::GUEST, {})) {
+		// SSL_write may return after each record and pick up the rest later from a grown buffer
+		if (m_ssl) SSL_set_mode(m_ssl, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
 	}
 
 	~RemoteClient() {
+		if (m_ssl) {
+			SSL_shutdown(m_ssl);
+			SSL_free(m_ssl);
+			m_ssl = nullptr;
+		}
 		if (this->m_socket == INVALID_SOCKET) return;
-		shutdown(this->m_socket, SD_BOTH);
-		closesocket(this->m_socket);
-		if (!m_ssl) return;
-		SSL_shutdown(m_ssl);
-		SSL_free(m_ssl);
-		m_ssl = nullptr;
+		Socket::close(this->m_socket);
 	}
 
-	uint32_t getHost() const { return m_address.sin_addr.S_un.S_addr; }
+	uint32_t getHost() const { return m_address.sin_addr.s_addr; }
 	uint16_t getPort() const { return m_address.sin_port; }
-	SocketStatus getStatus() const { return m_status; }
-	auto lock() { return std::lock_guard(m_access_mtx); }
+	ClientKey getKey() const { return ClientKey{ getHost(), getPort() }; }
+	SOCKET getSocket() const { return m_socket; }
+	SocketStatus getStatus() const { return m_status.load(std::memory_order_acquire); }
+	bool isHandshakeDone() const { return m_handshake_done; }
+	WireFormat getWireFormat() const { return m_wire_format; }
+	void setWireFormat(WireFormat format) { m_wire_format = format; }
+	bool hasPendingOutput() const { return m_pending_bytes.load() != 0; }
+	std::chrono::steady_clock::duration idleFor() const {
+		return std::chrono::steady_clock::now() - std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(m_last_activity.load()));
+	}
+	uint32_t getPollInterest() const {
+		if (m_want_write || hasPendingOutput()) return EV_READ | EV_WRITE;
+		return EV_READ;
+	}
+	std::shared_ptr<Strand> const& getStrand() const { return m_strand; }
+
+	// Taken on the strand when a write is handed off and kept alive until it
+	// was answered, or dropped unanswered
+	using WriteTicket = std::shared_ptr<void>;
+	WriteTicket beginWrite();
+	// Runs a read-only query on m_queries once no earlier write is pending
+	void postQuery(Task&& query);
 
 	std::string getFullIP() const;
-	std::vector<uint8_t> receiveData();
-	bool sendData(class Packet const& packet) const;
+	bool doHandshake();
+	bool receiveData(std::vector<std::vector<uint8_t>>& frames);
+	bool sendData(class Packet const& packet);
+	bool flush();
+	bool tryDispatch();
+	void rearm();
 	SocketStatus disconnect() noexcept;
 	void onConnect();
 	void onDisconnect();
 private:
-	bool sendData(const void* buffer, const size_t size) const;
-	void handleSSLError(int result);
+	bool sendData(const void* buffer, const size_t size);
+	bool flushLocked();
+	void requestWrite();
+	bool handleSSLError(int result);
+	void closeLocked() noexcept;
+	void endWrite();
 };
 
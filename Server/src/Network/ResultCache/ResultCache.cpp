@@ -0,0 +1,31 @@
+#include "ResultCache.hpp"
+
+uint64_t ResultCache::generation(TableID id) {
+    auto& cache = this->table(id);
+    std::lock_guard lock(cache.mtx);
+    return cache.generation;
+}
+
+ResultCache::Entry ResultCache::find(TableID id, std::string const& key) {
+    auto& cache = this->table(id);
+    std::lock_guard lock(cache.mtx);
+    auto it = cache.entries.find(key);
+    return it != cache.entries.end() ? it->second : nullptr;
+}
+
+void ResultCache::store(TableID id, uint64_t generation, std::string key, Entry entry) {
+    auto& cache = this->table(id);
+    std::lock_guard lock(cache.mtx);
+    if (cache.generation != generation) return;
+
+    if (cache.entries.size() >= max_entries_per_table)
+        cache.entries.clear();
+    cache.entries.insert_or_assign(std::move(key), std::move(entry));
+}
+
+void ResultCache::invalidate(TableID id) {
+    auto& cache = this->table(id);
+    std::lock_guard lock(cache.mtx);
+    ++cache.generation;
+    cache.entries.clear();
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <stdint.h>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "../Core/DatabaseSchema.hpp"
+
+// Serialized GetData results per table, keyed by everything that shapes the
+// text (layout and query). A hit is handed to ResponsePacket as shared text,
+// so a repeated fetch skips SQLite and serialization altogether.
+//
+// Writers call invalidate() after they committed. Each table has a
+// generation that invalidate() bumps, a reader notes it before running its
+// query and store() drops the result if a write happened in between, so a
+// snapshot older than the last write never gets cached.
+class ResultCache
+{
+public:
+	using Entry = std::shared_ptr<const std::string>;
+
+	// A table past this many distinct queries starts over
+	static constexpr size_t max_entries_per_table = 64;
+
+private:
+	struct Table {
+		std::mutex								mtx;
+		uint64_t								generation = 0;
+		std::unordered_map<std::string, Entry>	entries;
+	};
+
+	std::array<Table, s_tables.size()>	m_tables;
+
+	Table& table(TableID id) { return m_tables.at(static_cast<size_t>(id)); }
+
+public:
+	uint64_t generation(TableID id);
+	Entry find(TableID id, std::string const& key);
+	void store(TableID id, uint64_t generation, std::string key, Entry entry);
+	void invalidate(TableID id);
+};
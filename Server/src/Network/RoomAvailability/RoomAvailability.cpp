@@ -0,0 +1,146 @@
+#include "RoomAvailability.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <mutex>
+
+// Bookings that hold their room, cancelled ones free it again
+static constexpr const char* live_stays_sql =
+    "SELECT id, room_id, check_in_date, check_out_date FROM Bookings WHERE status <> 'отменено'";
+
+std::optional<RoomAvailability::Day> RoomAvailability::parseDate(std::string_view date) {
+    if (date.size() < 10 || date[4] != '-' || date[7] != '-') return std::nullopt;
+
+    auto number = [&date](size_t pos, size_t len) {
+        int value = 0;
+        for (size_t i = pos; i < pos + len; ++i) {
+            if (date[i] < '0' || date[i] > '9') return -1;
+            value = value * 10 + (date[i] - '0');
+        }
+        return value;
+    };
+
+    const int year = number(0, 4), month = number(5, 2), day = number(8, 2);
+    if (year < 0 || month < 0 || day < 0) return std::nullopt;
+
+    const std::chrono::year_month_day ymd{ std::chrono::year(year), std::chrono::month(month), std::chrono::day(day) };
+    if (!ymd.ok()) return std::nullopt;
+    return static_cast<Day>(std::chrono::sys_days(ymd).time_since_epoch().count());
+}
+
+void RoomAvailability::buildReach(Room& room) {
+    std::sort(room.stays.begin(), room.stays.end(), [](Stay const& a, Stay const& b) { return a.checkIn < b.checkIn; });
+
+    room.reach.resize(room.stays.size());
+    Day reach = std::numeric_limits<Day>::min();
+    for (size_t i = 0; i < room.stays.size(); ++i)
+        room.reach[i] = reach = std::max(reach, room.stays[i].checkOut);
+}
+
+bool RoomAvailability::isFree(Room const& room, Day from, Day to) {
+    if (!room.available) return false;
+
+    // Stays starting before `to` form a prefix, one of them overlaps iff it ends after `from`
+    auto end = std::lower_bound(room.stays.begin(), room.stays.end(), to,
+        [](Stay const& stay, Day day) { return stay.checkIn < day; });
+    if (end == room.stays.begin()) return true;
+    return room.reach[(end - room.stays.begin()) - 1] <= from;
+}
+
+void RoomAvailability::load(SQLite::Database& db) {
+    std::map<int64_t, Room> rooms;
+    std::unordered_map<int64_t, int64_t> bookingRoom;
+
+    SQLite::Statement roomQuery(db, "SELECT id, capacity, availability FROM Rooms");
+    while (roomQuery.executeStep()) {
+        auto& room = rooms[roomQuery.getColumn(0).getInt64()];
+        room.capacity = roomQuery.getColumn(1).getInt64();
+        room.available = roomQuery.getColumn(2).getInt() != 0;
+    }
+
+    SQLite::Statement stayQuery(db, live_stays_sql);
+    while (stayQuery.executeStep()) {
+        auto it = rooms.find(stayQuery.getColumn(1).getInt64());
+        auto checkIn = parseDate(stayQuery.getColumn(2).getText());
+        auto checkOut = parseDate(stayQuery.getColumn(3).getText());
+        if (it == rooms.end() || !checkIn || !checkOut) continue;
+
+        const int64_t bookingId = stayQuery.getColumn(0).getInt64();
+        it->second.stays.push_back({ *checkIn, *checkOut, bookingId });
+        bookingRoom.emplace(bookingId, it->first);
+    }
+
+    for (auto& [id, room] : rooms)
+        buildReach(room);
+
+    std::unique_lock lock(m_mtx);
+    m_rooms = std::move(rooms);
+    m_bookingRoom = std::move(bookingRoom);
+}
+
+void RoomAvailability::readRoom(SQLite::Database& db, int64_t roomId) {
+    // Caller holds the lock exclusively
+    if (auto it = m_rooms.find(roomId); it != m_rooms.end()) {
+        for (auto const& stay : it->second.stays)
+            m_bookingRoom.erase(stay.bookingId);
+        m_rooms.erase(it);
+    }
+
+    SQLite::Statement roomQuery(db, "SELECT capacity, availability FROM Rooms WHERE id = ?");
+    roomQuery.bind(1, roomId);
+    if (!roomQuery.executeStep()) return;
+
+    Room room;
+    room.capacity = roomQuery.getColumn(0).getInt64();
+    room.available = roomQuery.getColumn(1).getInt() != 0;
+
+    SQLite::Statement stayQuery(db, std::string(live_stays_sql) + " AND room_id = ?");
+    stayQuery.bind(1, roomId);
+    while (stayQuery.executeStep()) {
+        auto checkIn = parseDate(stayQuery.getColumn(2).getText());
+        auto checkOut = parseDate(stayQuery.getColumn(3).getText());
+        if (!checkIn || !checkOut) continue;
+
+        const int64_t bookingId = stayQuery.getColumn(0).getInt64();
+        room.stays.push_back({ *checkIn, *checkOut, bookingId });
+        m_bookingRoom[bookingId] = roomId;
+    }
+
+    buildReach(room);
+    m_rooms.emplace(roomId, std::move(room));
+}
+
+void RoomAvailability::reloadRoom(SQLite::Database& db, int64_t roomId) {
+    std::unique_lock lock(m_mtx);
+    this->readRoom(db, roomId);
+}
+
+void RoomAvailability::reloadBooking(SQLite::Database& db, int64_t bookingId) {
+    SQLite::Statement query(db, "SELECT room_id FROM Bookings WHERE id = ?");
+    query.bind(1, bookingId);
+    std::optional<int64_t> newRoom;
+    if (query.executeStep()) newRoom = query.getColumn(0).getInt64();
+
+    std::unique_lock lock(m_mtx);
+    if (auto it = m_bookingRoom.find(bookingId); it != m_bookingRoom.end() && it->second != newRoom)
+        this->readRoom(db, it->second);
+    if (newRoom)
+        this->readRoom(db, *newRoom);
+}
+
+bool RoomAvailability::isFree(int64_t roomId, Day from, Day to) const {
+    std::shared_lock lock(m_mtx);
+    auto it = m_rooms.find(roomId);
+    return it != m_rooms.end() && isFree(it->second, from, to);
+}
+
+std::vector<int64_t> RoomAvailability::freeRooms(Day from, Day to, int64_t capacity) const {
+    std::vector<int64_t> result;
+
+    std::shared_lock lock(m_mtx);
+    for (auto const& [id, room] : m_rooms)
+        if (room.capacity >= capacity && isFree(room, from, to))
+            result.push_back(id);
+    return result;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <stdint.h>
+#include <map>
+#include <optional>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+// In memory copy of which nights every room is taken, so availability
+// questions never touch SQLite. Per room the live (not cancelled) stays are
+// kept sorted by check in together with the running maximum of their check
+// out days - a flattened interval tree: the stays starting before a range
+// ends are a prefix, and they reach into the range iff the prefix maximum
+// does. A lookup is one binary search, a change rebuilds one room.
+//
+// The index is loaded at startup and refreshed by the handlers after every
+// write to Rooms or Bookings, always on the writer connection so the copy
+// follows the committed order of writes.
+class RoomAvailability
+{
+public:
+	// Days since 1970-01-01
+	using Day = int32_t;
+
+	// "YYYY-MM-DD" as validated by Validators::isDate
+	static std::optional<Day> parseDate(std::string_view date);
+
+private:
+	struct Stay {
+		Day		checkIn;
+		Day		checkOut;
+		int64_t	bookingId;
+	};
+
+	struct Room {
+		int64_t				capacity = 0;
+		bool				available = true;
+		std::vector<Stay>	stays;			// by checkIn
+		std::vector<Day>	reach;			// reach[i] - latest checkOut of stays[0..i]
+	};
+
+	mutable std::shared_mutex					m_mtx;
+	std::map<int64_t, Room>						m_rooms;
+	std::unordered_map<int64_t, int64_t>		m_bookingRoom;	// live booking -> room
+
+	static void buildReach(Room& room);
+	static bool isFree(Room const& room, Day from, Day to);
+	void readRoom(SQLite::Database& db, int64_t roomId);
+
+public:
+	void load(SQLite::Database& db);
+	// Re-reads one room and its stays, a room that is gone is dropped
+	void reloadRoom(SQLite::Database& db, int64_t roomId);
+	// Re-reads the rooms a booking was and now is in, after it was added, edited or deleted
+	void reloadBooking(SQLite::Database& db, int64_t bookingId);
+
+	// Whether the room exists, is available and has no stay overlapping [from, to)
+	bool isFree(int64_t roomId, Day from, Day to) const;
+	// Rooms free over [from, to) that hold at least capacity guests, by id
+	std::vector<int64_t> freeRooms(Day from, Day to, int64_t capacity) const;
+};
@@ -2,11 +2,11 @@
 #include "../../Utils/Json.hpp"
 #include "../../Utils/base64.hpp"
 #include "../../Network/PacketManager/PacketManager.hpp"
+#include "../Core/DatabaseSchema.hpp"
 
 #include <openssl/x509.h>
 #include <openssl/pem.h>
 #include <bcrypt_.h>
-#include <mstcpip.h>
 #include <print>
 
 static bool createSelfSignedCert(SSL_CTX* ctx) {
@@ -71,23 +71,22 @@ static bool createSelfSignedCert(SSL_CTX* ctx) {
 Server::Server(
     const uint16_t port,
     KeepAliveConfig ka_conf,
-    unsigned int thread_count
+    unsigned int thread_count,
+    size_t max_queries
 ) : m_port(port),
     m_thread_pool(thread_count),
+    m_hash_executor(std::max(1u, thread_count / 4), max_hash_queue),
     m_ka_conf(ka_conf),
     m_status(ServerStatus::close),
-    m_db(SQLite::Database("database.db", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE | SQLite::OPEN_FULLMUTEX)),
-    m_ssl_ctx(nullptr)
+    m_db("database.db", thread_count),
+    m_max_queries(max_queries),
+    m_ssl_ctx(nullptr),
+    m_idle_timer(0),
+    m_session_timer(0),
+    m_write_queue(m_db)
 {
-	if (auto err = WSAStartup(MAKEWORD(2, 2), &m_wData); err != 0) {
-		char buffer[256];
-		strerror_s(buffer, sizeof(buffer), err);
-        std::println(stderr,
-            "WSAStartup error!\n"
-            "Code: {} Err: {}",
-            err, buffer);
-		exit(1);
-	}
+    if (!Socket::startup())
+        exit(1);
 
     this->initDatabase();
 
@@ -113,46 +112,21 @@ Server::Server(
 void Server::initDatabase()
 {
     try {
-        // (Users)
-        m_db.exec(
-            "CREATE TABLE IF NOT EXISTS Users ("
-            "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-            "email TEXT UNIQUE NOT NULL, "
-            "password_hash TEXT NOT NULL, "
-            "first_name TEXT NOT NULL, "
-            "last_name TEXT NOT NULL, "
-            "phone_number TEXT, "
-            "role TEXT CHECK(role IN ('guest', 'admin')) NOT NULL DEFAULT 'guest', "
-            "created_at DATETIME DEFAULT CURRENT_TIMESTAMP, "
-            "updated_at DATETIME DEFAULT CURRENT_TIMESTAMP);"
-        );
+        auto db = m_db.writer();
 
-        // (Rooms)
-        m_db.exec(
-            "CREATE TABLE IF NOT EXISTS Rooms ("
-            "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-            "room_type TEXT NOT NULL, "
-            "price_per_night REAL NOT NULL, "
-            "capacity INTEGER NOT NULL, "
-            "availability BOOLEAN NOT NULL DEFAULT 1, "
-            "description TEXT);"
-        );
+        // CREATE statements are generated from the table descriptors in DatabaseSchema.hpp
+        for (auto const* table : s_tables)
+            db->exec(std::string(tableStatements(table->id).create));
 
-        // (Bookings)
-        m_db.exec(
-            "CREATE TABLE IF NOT EXISTS Bookings ("
-            "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-            "user_id INTEGER NOT NULL, "
-            "room_id INTEGER NOT NULL, "
-            "check_in_date DATETIME NOT NULL, "
-            "check_out_date DATETIME NOT NULL, "
-            "booking_date DATETIME DEFAULT CURRENT_TIMESTAMP, "
-            "status TEXT CHECK(status IN ('подтверждено', 'отменено', 'завершено')) NOT NULL DEFAULT 'подтверждено', "
-            "FOREIGN KEY(user_id) REFERENCES Users(id) ON DELETE CASCADE, "
-            "FOREIGN KEY(room_id) REFERENCES Rooms(id) ON DELETE CASCADE);"
-        );
+        // Backs the filters and orderings the bookings screen pages through
+        db->exec("CREATE INDEX IF NOT EXISTS idx_bookings_user_id ON Bookings(user_id);");
+        db->exec("CREATE INDEX IF NOT EXISTS idx_bookings_check_in_date ON Bookings(check_in_date);");
+        db->exec("CREATE INDEX IF NOT EXISTS idx_bookings_check_out_date ON Bookings(check_out_date);");
+        db->exec("CREATE INDEX IF NOT EXISTS idx_bookings_booking_date ON Bookings(booking_date);");
+        // Overlap checks and free room lookups probe one room's stays by date
+        db->exec("CREATE INDEX IF NOT EXISTS idx_bookings_room_dates ON Bookings(room_id, check_in_date, check_out_date);");
 
-        m_db.exec(
+        db->exec(
             "CREATE TRIGGER IF NOT EXISTS update_users_updated_at "
             "AFTER UPDATE ON Users "
             "FOR EACH ROW "
@@ -161,9 +135,7 @@ void Server::initDatabase()
             "END;"
         );
 
-        m_db.exec("PRAGMA foreign_keys = ON;");        
-
-        /*m_db.exec(std::format(R"(INSERT INTO Users(email, password_hash, first_name, last_name, phone_number, role) VALUES
+        /*db->exec(std::format(R"(INSERT INTO Users(email, password_hash, first_name, last_name, phone_number, role) VALUES
             ('ivanov1@example.ru', '{0}', 'Иван', 'Иванов', '+79261234567', 'guest'),
             ('petrova2@example.ru', '{1}', 'Анна', 'Петрова', '+79031234568', 'admin'),
             ('sidorov3@example.ru', '{2}', 'Сидор', 'Сидоров', '+79876543210', 'guest'),
@@ -210,7 +182,7 @@ void Server::initDatabase()
             )
         );
 
-        m_db.exec(R"(
+        db->exec(R"(
             INSERT INTO Rooms(room_type, price_per_night, capacity, availability, description) VALUES
             ('Одноместный', 2500.00, 1, 1, 'Уютный номер для одного человека с видом на город'),
             ('Двухместный', 3900.50, 2, 1, 'Комфортабельный номер с двуспальной кроватью'),
@@ -234,7 +206,7 @@ void Server::initDatabase()
             ('Одноместный', 2600.00, 1, 0, 'Номер для деловой поездки с хорошим освещением');
         )");
 
-        m_db.exec(R"(
+        db->exec(R"(
             INSERT INTO Bookings(user_id, room_id, check_in_date, check_out_date, status) VALUES
             (1, 3, '2025-06-10', '2025-06-15', 'подтверждено'),
             (2, 5, '2025-07-01', '2025-07-07', 'подтверждено'),
@@ -258,6 +230,7 @@ void Server::initDatabase()
             (20, 5, '2025-08-10', '2025-08-12', 'подтверждено');
         )");*/
 
+        m_availability.load(db);
     }
     catch (const SQLite::Exception& e) {
         std::println(stderr, "Exception: {}", e.what());
@@ -268,114 +241,203 @@ void Server::initDatabase()
 Server::~Server() {
 	if (m_status == ServerStatus::up)
 		stop();
-	WSACleanup();
+    Socket::cleanup();
 }
 
-bool Server::enableKeepAlive(SOCKET socket) {
-    int flag = 1;
+void Server::reactorLoop() {
+    std::vector<ReactorEventData> events;
+    while (m_status == ServerStatus::up) {
+        m_reactor.wait(events);
 
-    tcp_keepalive ka{ 1, m_ka_conf.ka_idle * 1000, m_ka_conf.ka_intvl * 1000 };
-    if (setsockopt(socket, SOL_SOCKET, SO_KEEPALIVE, reinterpret_cast<const char*>(&flag), sizeof(flag)) != 0) return false;
-    unsigned long numBytesReturned = 0;
-    if (WSAIoctl(socket, SIO_KEEPALIVE_VALS, &ka, sizeof(ka), nullptr, 0, &numBytesReturned, 0, nullptr) != 0) return false;
+        for (const auto& event : events) {
+            if (event.key == listener_key) {
+                acceptConnections();
+                continue;
+            }
 
-    return true;
+            // A job already owning this client re-arms on its own, the event isn't lost
+            auto client = findClient(event.key);
+            if (!client || !client->tryDispatch()) continue;
+
+            m_thread_pool.addJob([this, client, ev = event.events] { handleClientEvent(client, ev); });
+        }
+    }
 }
 
-void Server::handlingAcceptLoop() {
-    int addrlen = sizeof(SOCKADDR_IN);
-    SOCKADDR_IN client_addr;
-    if (SOCKET client_socket = accept(m_serv_socket, reinterpret_cast<struct sockaddr*>(&client_addr), &addrlen);
-        client_socket != INVALID_SOCKET && m_status == ServerStatus::up) {  
-
-        if (enableKeepAlive(client_socket)) {
-            SSL* ssl = SSL_new(m_ssl_ctx);
-            SSL_set_fd(ssl, client_socket);
-
-            if (SSL_accept(ssl) <= 0) {
-                ERR_print_errors_fp(stderr);
-                SSL_free(ssl);
-                shutdown(client_socket, SD_BOTH);
-                closesocket(client_socket);
-                return;
-            }
+void Server::acceptConnections() {
+    while (m_status == ServerStatus::up) {
+        socklen_t addrlen = sizeof(SOCKADDR_IN);
+        SOCKADDR_IN client_addr;
+        SOCKET client_socket = accept(m_serv_socket, reinterpret_cast<struct sockaddr*>(&client_addr), &addrlen);
+        if (client_socket == INVALID_SOCKET) break;
 
-            std::unique_ptr<RemoteClient> client = std::make_unique<RemoteClient>(client_socket, client_addr, ssl);
-            client->onConnect();
-            std::lock_guard<std::mutex> lock(m_client_mutex); 
-            m_client_list.emplace(std::move(client));
-        }
-        else {
-            shutdown(client_socket, SD_BOTH);
-            closesocket(client_socket);
-        }
+        acceptClient(client_socket, client_addr);
     }
 
     if (m_status == ServerStatus::up)
-        m_thread_pool.addJob([this]() { handlingAcceptLoop(); });
+        m_reactor.rearm(m_serv_socket, listener_key, EV_READ);
 }
 
-void Server::dataReceivingLoop() {
-    [this] {
-        std::lock_guard lock(m_client_mutex);
-        for (auto it = m_client_list.begin(); it != m_client_list.end();) {
+void Server::acceptClient(SOCKET client_socket, SOCKADDR_IN client_addr) {
+    // Accepted sockets only inherit the listener's non-blocking mode on Windows
+    if (!Socket::enableKeepAlive(client_socket, m_ka_conf) || !Socket::setNonBlocking(client_socket, true)) {
+        Socket::close(client_socket);
+        return;
+    }
 
-            auto& client = *it;
+    SSL* ssl = SSL_new(m_ssl_ctx);
+    if (!ssl) {
+        Socket::close(client_socket);
+        return;
+    }
 
-            if (const auto& data = client->receiveData(); !data.empty()) {
-                m_thread_pool.addJob([this, _data = std::move(data), &client = *client] {
+    SSL_set_fd(ssl, static_cast<int>(client_socket));
+    SSL_set_accept_state(ssl);
 
-                    std::lock_guard client_lock(client.m_access_mtx);
+    // The handshake is driven by reactor events like any other read, a client
+    // stalling mid handshake doesn't hold a worker
+    registerClient(std::make_shared<RemoteClient>(client_socket, client_addr, ssl, false));
+}
 
-                    auto badPacket_func = [&client] {
-                        Packet pckt;
-                        client.sendData(pckt);
-                        client.disconnect();
-                        std::println(stderr, "Bad Packet Error");
-                    };
+void Server::registerClient(std::shared_ptr<RemoteClient> client) {
+    auto socket = client->getSocket();
+    auto key = client->getKey().value();
+    client->m_reactor = &m_reactor;
+    client->m_strand = std::make_shared<Strand>(m_thread_pool);
+    client->m_queries = std::make_shared<ConcurrencyLimiter>(m_thread_pool, m_max_queries);
+    {
+        std::lock_guard<std::mutex> lock(m_client_mutex);
+        m_client_list.emplace(std::move(client));
+    }
+    m_reactor.add(socket, key, EV_READ);
+}
 
-                    try {
-                        std::string rawData(_data.begin(), _data.end());
-                        rawData = base64::from_base64(rawData);
+std::shared_ptr<RemoteClient> Server::findClient(uint64_t key) {
+    std::lock_guard lock(m_client_mutex);
+    if (auto it = m_client_list.find(ClientKey::fromValue(key)); it != m_client_list.end())
+        return *it;
+    return nullptr;
+}
 
-                        nlohmann::json data = nlohmann::json::parse(rawData);
+void Server::handleClientEvent(std::shared_ptr<RemoteClient> const& client, uint32_t events) {
+    if (!client->isHandshakeDone()) {
+        if (client->doHandshake())
+            client->onConnect();
+        else if (client->getStatus() == SocketStatus::connected)
+            client->rearm();
+        else
+            removeClient(client);
+
+        if (!client->isHandshakeDone()) return;
+    }
 
-                        auto packet = PacketManager::CreatePacket(data);
-                        if (packet->getID() == PacketID::Unknown) { badPacket_func(); }
+    // Responses that didn't fit into the socket earlier
+    if (client->hasPendingOutput())
+        client->flush();
 
-                        std::println("Handling packet: {} from {}", packet->toString(), client.clientData.login);
-                        packet->handlePacket(*this, client);
-                    }
-                    catch (...) {
-                        badPacket_func();
-                    }
-                    });
-            }
+    std::vector<std::vector<uint8_t>> frames;
+    bool has_more = client->receiveData(frames);
 
-            if (client->m_status == SocketStatus::disconnected &&
-                !client->isDisconnecting.exchange(true)) {
+    for (auto& frame : frames) {
+        client->m_strand->post([this, client, _data = std::move(frame)] {
+            processPacket(*client, _data);
+            if (client->getStatus() == SocketStatus::disconnected)
+                removeClient(client);
+        });
+    }
 
-                //auto client_node = m_client_list.extract(it++);
-                m_thread_pool.addJob([this, it = it++]() {
-                    std::lock_guard list_lock(m_client_mutex);
+    // Read budget ran out with plaintext still buffered inside SSL, the socket
+    // won't signal it again so continue from a fresh job
+    if (has_more) {
+        m_thread_pool.addJob([this, client, events] { handleClientEvent(client, events); });
+        return;
+    }
 
-                    auto client_node = m_client_list.extract(it);
-                    auto&& client = std::move(client_node.value());
-                    
-                    std::lock_guard client_lock(client->m_access_mtx);
-                    client->onDisconnect();
-                });
+    // Peer hung up, everything it sent before that has been read above
+    if (client->getStatus() == SocketStatus::disconnected || (events & EV_CLOSE)) {
+        removeClient(client);
+        return;
+    }
 
-                continue;  
-            }
-            else {
-                ++it; 
-            }
+    client->rearm();
+}
+
+void Server::processPacket(RemoteClient& client, std::vector<uint8_t> const& _data) {
+    auto badPacket_func = [&client] {
+        Packet pckt;
+        client.sendData(pckt);
+        client.disconnect();
+        std::println(stderr, "Bad Packet Error");
+    };
+
+    try {
+        std::unique_ptr<Packet> packet;
+        if (!_data.empty() && _data.front() == BinaryStream::magic) {
+            BinaryReader reader(_data.data(), _data.size());
+            packet = PacketManager::CreatePacket(reader);
+            client.setWireFormat(WireFormat::binary);
         }
-        }();
+        else {
+            std::string rawData(_data.begin(), _data.end());
+            rawData = base64::from_base64(rawData);
 
-    if (m_status == ServerStatus::up)
-        m_thread_pool.addJob(std::bind(&Server::dataReceivingLoop, this));
+            JsonFields::Frame frame;
+            packet = PacketManager::CreatePacket(rawData, frame);
+            client.setWireFormat(frame.inlineData ? WireFormat::json_inline : WireFormat::json);
+        }
+
+        if (packet->getID() == PacketID::Unknown) { badPacket_func(); return; }
+
+        std::println("Handling packet: {} from {}", packet->getName(), client.clientData.login);
+        if (!packet->isReadOnly()) {
+            packet->handlePacket(*this, client);
+            return;
+        }
+
+        // The strand moves on to the next frame, a Login or Logout behind the
+        // query doesn't change who it is answered for. A write of the client
+        // still pending holds it back
+        client.postQuery([this, self = client.shared_from_this(), packet = std::shared_ptr<Packet>(std::move(packet)), requester = client.clientData] {
+            packet->handleQuery(*this, *self, requester);
+            if (self->getStatus() == SocketStatus::disconnected)
+                removeClient(self);
+        });
+    }
+    catch (...) {
+        badPacket_func();
+    }
+}
+
+void Server::removeClient(std::shared_ptr<RemoteClient> const& client) {
+    if (client->isDisconnecting.exchange(true)) return;
+
+    // Deregister while the descriptor is still open, a recycled one must not be dropped
+    if (client->getSocket() != INVALID_SOCKET)
+        m_reactor.remove(client->getSocket());
+
+    {
+        std::lock_guard list_lock(m_client_mutex);
+        m_client_list.erase(client);
+    }
+    m_change_feed.unsubscribeAll(*client);
+
+    client->disconnect();
+    client->onDisconnect();
+}
+
+void Server::dropIdleClients() {
+    m_client_mutex.lock();
+    auto clients = std::vector(m_client_list.begin(), m_client_list.end());
+    m_client_mutex.unlock();
+
+    for (const auto& client : clients) {
+        // Half open handshakes get much less slack than established sessions
+        auto timeout = client->isHandshakeDone() ? idle_timeout : handshake_timeout;
+        if (client->idleFor() < timeout) continue;
+
+        std::println("Client {} timed out", client->getFullIP());
+        removeClient(client);
+    }
 }
 
 ServerStatus Server::start() {
@@ -383,7 +445,7 @@ ServerStatus Server::start() {
     if (m_status == ServerStatus::up) stop();
 
     SOCKADDR_IN address;
-    address.sin_addr.S_un.S_addr = INADDR_ANY;
+    address.sin_addr.s_addr = INADDR_ANY;
     address.sin_port = htons(m_port);
     address.sin_family = AF_INET;
 
@@ -391,7 +453,7 @@ ServerStatus Server::start() {
     if ((m_serv_socket = socket(AF_INET, SOCK_STREAM, 0)) == INVALID_SOCKET)
         return m_status = ServerStatus::err_socket_init;
 
-    if (unsigned long mode = 0; ioctlsocket(m_serv_socket, FIONBIO, &mode) == SOCKET_ERROR) {
+    if (!Socket::setNonBlocking(m_serv_socket, true)) {
         return m_status = ServerStatus::err_socket_init;
     }
 
@@ -403,16 +465,27 @@ ServerStatus Server::start() {
     if (listen(m_serv_socket, SOMAXCONN) == SOCKET_ERROR)
         return m_status = ServerStatus::err_socket_listening;
 
+    if (!m_reactor.open() || !m_reactor.add(m_serv_socket, listener_key, EV_READ))
+        return m_status = ServerStatus::err_socket_init;
+
     m_status = ServerStatus::up;
-    m_thread_pool.addJob(std::bind(&Server::handlingAcceptLoop, this));
-    m_thread_pool.addJob(std::bind(&Server::dataReceivingLoop, this));
+    m_reactor_thread = std::thread(&Server::reactorLoop, this);
+    m_idle_timer = m_thread_pool.addPeriodic(std::chrono::seconds(1), [this] { dropIdleClients(); });
+    m_session_timer = m_thread_pool.addPeriodic(std::chrono::minutes(1), [this] { m_sessions.dropExpired(); });
     return m_status;
 }
 
 void Server::stop() {
-    m_thread_pool.dropUnstartedJobs();
     m_status = ServerStatus::close;
-    closesocket(m_serv_socket);
+    m_reactor.wakeup();
+    if (m_reactor_thread.joinable())
+        m_reactor_thread.join();
+
+    m_thread_pool.cancelTimer(m_idle_timer);
+    m_thread_pool.cancelTimer(m_session_timer);
+    m_thread_pool.dropUnstartedJobs();
+    m_reactor.remove(m_serv_socket);
+    Socket::close(m_serv_socket);
     m_client_list.clear();
 }
 
@@ -426,19 +499,18 @@ bool Server::connectTo(uint32_t host, uint16_t port) {
     address.sin_port = htons(port);
 
     if (connect(client_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR) {
-        closesocket(client_socket);
+        Socket::close(client_socket);
         return false;
     }
 
-    if (!enableKeepAlive(client_socket)) {
-        shutdown(client_socket, SD_BOTH);
-        closesocket(client_socket);
+    if (!Socket::enableKeepAlive(client_socket, m_ka_conf)) {
+        Socket::close(client_socket);
         return false;
     }
 
     SSL* ssl = SSL_new(m_ssl_ctx);
     if (!ssl) {
-        closesocket(client_socket);
+        Socket::close(client_socket);
         return false;
     }
 
@@ -447,16 +519,15 @@ bool Server::connectTo(uint32_t host, uint16_t port) {
     if (SSL_connect(ssl) != 1) {
         ERR_print_errors_fp(stderr);
         SSL_free(ssl);
-        closesocket(client_socket);
+        Socket::close(client_socket);
         return false;
     }
 
-    auto client = std::make_unique<RemoteClient>(client_socket, address, ssl);
-    client->onConnect();
-
-    std::scoped_lock lock(m_client_mutex);
-    m_client_list.emplace(std::move(client));
+    Socket::setNonBlocking(client_socket, true);
 
+    auto client = std::make_shared<RemoteClient>(client_socket, address, ssl);
+    client->onConnect();
+    registerClient(std::move(client));
     return true;
 }
 
@@ -478,21 +549,18 @@ bool Server::sendDataBy(uint32_t host, uint16_t port, Packet const& packet) {
 }
 
 bool Server::disconnectBy(uint32_t host, uint16_t port) {
-    m_client_mutex.lock();
-    bool client_is_disconnected = false;
-    for (const auto& client : m_client_list)
-        if (client->getHost() == host && client->getPort() == port) {
-            client->disconnect();
-            client_is_disconnected = true;
-            break;
-        }
-    m_client_mutex.unlock();
-    return client_is_disconnected;
+    auto client = findClient(ClientKey{ host, port }.value());
+    if (!client) return false;
+
+    removeClient(client);
+    return true;
 }
 
 void Server::disconnectAll() {
     m_client_mutex.lock();
-    for (const auto& client : m_client_list)
-        client->disconnect();
+    auto clients = std::vector(m_client_list.begin(), m_client_list.end());
     m_client_mutex.unlock();
+
+    for (const auto& client : clients)
+        removeClient(client);
 }
\ No newline at end of file
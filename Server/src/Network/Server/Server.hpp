@@ -4,7 +4,15 @@
 #include "../Core/ServerStatus.hpp"
 #include "../Core/ClientComparator.hpp"
 #include "../RemoteClient/RemoteClient.hpp"
+#include "../Reactor/Reactor.hpp"
+#include "../SessionStore/SessionStore.hpp"
+#include "../RoomAvailability/RoomAvailability.hpp"
+#include "../ResultCache/ResultCache.hpp"
+#include "../ChangeFeed/ChangeFeed.hpp"
+#include "../WriteQueue/WriteQueue.hpp"
 #include "../../Utils/ThreadPool/ThreadPool.hpp"
+#include "../../Utils/ThreadPool/BoundedExecutor.hpp"
+#include "../../Utils/DatabasePool/DatabasePool.hpp"
 
 #include <SQLiteCpp/SQLiteCpp.h>
 #include <openssl/ssl.h>
@@ -13,37 +21,72 @@
 
 class Server
 {
-	using ClientIterator = std::set<std::unique_ptr<RemoteClient>, ClientComparator>::iterator;
+	using ClientIterator = std::set<std::shared_ptr<RemoteClient>, ClientComparator>::iterator;
+	static constexpr uint64_t listener_key = UINT64_MAX - 1;
+	static constexpr std::chrono::seconds handshake_timeout{ 10 };
+	static constexpr std::chrono::seconds idle_timeout{ 30 * 60 };
+	// Password hashes waiting for a hash thread before new logins are turned away
+	static constexpr size_t max_hash_queue = 64;
 private:
 	SOCKET														m_serv_socket;
-	WSAData														m_wData;
 	uint16_t													m_port;
 	ServerStatus												m_status;
 	ThreadPool													m_thread_pool;
+	BoundedExecutor												m_hash_executor;
 	KeepAliveConfig												m_ka_conf;
-	SQLite::Database											m_db;
-	std::set<std::unique_ptr<RemoteClient>, ClientComparator>	m_client_list;
+	DatabasePool												m_db;
+	size_t														m_max_queries;
+	SessionStore												m_sessions;
+	RoomAvailability											m_availability;
+	ResultCache													m_result_cache;
+	ChangeFeed													m_change_feed;
+	std::set<std::shared_ptr<RemoteClient>, ClientComparator>	m_client_list;
 	std::mutex													m_client_mutex;
 	SSL_CTX*													m_ssl_ctx;
+	Reactor														m_reactor;
+	std::thread													m_reactor_thread;
+	ThreadPool::TimerId											m_idle_timer;
+	ThreadPool::TimerId											m_session_timer;
+	// Last, so it is joined before anything its completions touch goes away
+	WriteQueue													m_write_queue;
 
 public:
 	Server(
 		const uint16_t port,
 		KeepAliveConfig ka_conf = { },
-		unsigned int thread_count = std::thread::hardware_concurrency()
+		unsigned int thread_count = std::thread::hardware_concurrency(),
+		// Read-only requests of one connection running at the same time
+		size_t max_queries = 8
 	);
 
 	~Server();
 
 private:
-	bool enableKeepAlive(SOCKET socket);
-	void handlingAcceptLoop();
-	void dataReceivingLoop();
+	void reactorLoop();
+	void acceptConnections();
+	void acceptClient(SOCKET client_socket, SOCKADDR_IN client_addr);
+	void registerClient(std::shared_ptr<RemoteClient> client);
+	void handleClientEvent(std::shared_ptr<RemoteClient> const& client, uint32_t events);
+	void processPacket(RemoteClient& client, std::vector<uint8_t> const& data);
+	void removeClient(std::shared_ptr<RemoteClient> const& client);
+	void dropIdleClients();
+	std::shared_ptr<RemoteClient> findClient(uint64_t key);
 	void initDatabase();
 
 public:
 	ThreadPool& getThreadPool() { return this->m_thread_pool; }
-	SQLite::Database& getDatabase() { return this->m_db; }
+	BoundedExecutor& getHashExecutor() { return this->m_hash_executor; }
+	SessionStore& getSessions() { return this->m_sessions; }
+	// Refreshed by whoever writes Rooms or Bookings, on the writer connection
+	RoomAvailability& getAvailability() { return this->m_availability; }
+	// Serialized GetData results, invalidated by whoever writes the table
+	ResultCache& getResultCache() { return this->m_result_cache; }
+	// Row deltas for subscribed clients, published by whoever writes a table
+	ChangeFeed& getChangeFeed() { return this->m_change_feed; }
+	// Read-only connection for queries. Anything that modifies goes through the
+	// write queue, its thread is the only user of the writer connection
+	DatabasePool::Lease getReader() { return this->m_db.reader(); }
+	WriteQueue& getWriteQueue() { return this->m_write_queue; }
 	void joinLoop() { m_thread_pool.join(); }
 	uint16_t getPort() const { return this->m_port; }
 	uint16_t setPort(const uint16_t port) {
@@ -0,0 +1,60 @@
+#include "SessionStore.hpp"
+
+#include <openssl/rand.h>
+#include <stdexcept>
+
+std::string SessionStore::generateToken() {
+    static constexpr char hex[] = "0123456789abcdef";
+
+    unsigned char bytes[32];
+    if (RAND_bytes(bytes, sizeof(bytes)) != 1)
+        throw std::runtime_error("RAND_bytes failed");
+
+    std::string token;
+    token.reserve(sizeof(bytes) * 2);
+    for (unsigned char byte : bytes) {
+        token += hex[byte >> 4];
+        token += hex[byte & 0xF];
+    }
+    return token;
+}
+
+std::string SessionStore::create(ClientData data, int64_t userId, nlohmann::json profile) {
+    auto token = generateToken();
+    data.sessionToken = token;
+
+    std::lock_guard lock(m_mtx);
+    m_sessions.insert_or_assign(token, Session{ std::move(data), userId, std::move(profile), Clock::now() + session_lifetime });
+    return token;
+}
+
+std::optional<SessionStore::Session> SessionStore::resume(std::string const& token) {
+    std::lock_guard lock(m_mtx);
+    auto it = m_sessions.find(token);
+    if (it == m_sessions.end()) return std::nullopt;
+
+    auto now = Clock::now();
+    if (it->second.expires <= now) {
+        m_sessions.erase(it);
+        return std::nullopt;
+    }
+
+    it->second.expires = now + session_lifetime;
+    return it->second;
+}
+
+void SessionStore::revoke(std::string const& token) {
+    std::lock_guard lock(m_mtx);
+    m_sessions.erase(token);
+}
+
+void SessionStore::revokeUser(int64_t userId) {
+    std::lock_guard lock(m_mtx);
+    std::erase_if(m_sessions, [userId](auto const& entry) { return entry.second.userId == userId; });
+}
+
+void SessionStore::dropExpired() {
+    auto now = Clock::now();
+    std::lock_guard lock(m_mtx);
+    std::erase_if(m_sessions, [now](auto const& entry) { return entry.second.expires <= now; });
+}
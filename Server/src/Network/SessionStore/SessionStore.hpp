@@ -0,0 +1,45 @@
+#pragma once
+#include <stdint.h>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "../Core/ClientData.hpp"
+#include "../../Utils/Json.hpp"
+
+// In memory table of login sessions. A successful login gets an opaque
+// random token, presenting it again (ResumeSessionPacket) restores the
+// client's state with one lookup instead of another bcrypt check. Sessions
+// expire after session_lifetime without use and do not survive a restart.
+class SessionStore
+{
+	using Clock = std::chrono::steady_clock;
+public:
+	static constexpr std::chrono::hours session_lifetime{ 24 };
+
+	struct Session {
+		ClientData		data;
+		int64_t			userId;
+		// What the login response carried, sent again on resume
+		nlohmann::json	profile;
+		Clock::time_point expires;
+	};
+
+private:
+	std::mutex									m_mtx;
+	std::unordered_map<std::string, Session>	m_sessions;
+
+	static std::string generateToken();
+
+public:
+	// Returns the new token
+	std::string create(ClientData data, int64_t userId, nlohmann::json profile);
+	// Looks the token up and extends its lifetime
+	std::optional<Session> resume(std::string const& token);
+	void revoke(std::string const& token);
+	// Drops every session of a user, e.g. after the account was changed or deleted
+	void revokeUser(int64_t userId);
+	void dropExpired();
+};
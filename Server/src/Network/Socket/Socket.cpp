@@ -0,0 +1,145 @@
+#include "Socket.hpp"
+
+#include <print>
+
+#ifdef _WIN32
+
+#include <mstcpip.h>
+
+bool Socket::startup()
+{
+    WSAData wData;
+    if (auto err = WSAStartup(MAKEWORD(2, 2), &wData); err != 0) {
+        std::println(stderr,
+            "WSAStartup error!\n"
+            "Code: {} Err: {}",
+            err, errorString(err));
+        return false;
+    }
+    return true;
+}
+
+void Socket::cleanup()
+{
+    WSACleanup();
+}
+
+bool Socket::setNonBlocking(SOCKET socket, bool enabled)
+{
+    u_long mode = enabled;
+    return ioctlsocket(socket, FIONBIO, &mode) != SOCKET_ERROR;
+}
+
+bool Socket::enableKeepAlive(SOCKET socket, KeepAliveConfig const& config)
+{
+    int flag = 1;
+
+    tcp_keepalive ka{ 1, config.ka_idle * 1000, config.ka_intvl * 1000 };
+    if (setsockopt(socket, SOL_SOCKET, SO_KEEPALIVE, reinterpret_cast<const char*>(&flag), sizeof(flag)) != 0) return false;
+    unsigned long numBytesReturned = 0;
+    if (WSAIoctl(socket, SIO_KEEPALIVE_VALS, &ka, sizeof(ka), nullptr, 0, &numBytesReturned, 0, nullptr) != 0) return false;
+
+    return true;
+}
+
+void Socket::close(SOCKET socket)
+{
+    shutdown(socket, SD_BOTH);
+    closesocket(socket);
+}
+
+bool Socket::waitReady(SOCKET socket, bool write, int timeout_ms)
+{
+    WSAPOLLFD fd{ socket, static_cast<SHORT>(write ? POLLWRNORM : POLLRDNORM), 0 };
+    return WSAPoll(&fd, 1, timeout_ms) > 0;
+}
+
+int Socket::lastError()
+{
+    return WSAGetLastError();
+}
+
+bool Socket::isWouldBlock(int error)
+{
+    return error == WSAEWOULDBLOCK;
+}
+
+std::string Socket::errorString(int error)
+{
+    char buffer[256];
+    strerror_s(buffer, sizeof(buffer), error);
+    return buffer;
+}
+
+#else
+
+#include <netinet/tcp.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+
+bool Socket::startup()
+{
+    // A peer resetting the connection mid SSL_write must not kill the process
+    signal(SIGPIPE, SIG_IGN);
+    return true;
+}
+
+void Socket::cleanup()
+{
+}
+
+bool Socket::setNonBlocking(SOCKET socket, bool enabled)
+{
+    int flags = fcntl(socket, F_GETFL, 0);
+    if (flags == -1) return false;
+    flags = enabled ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    return fcntl(socket, F_SETFL, flags) != -1;
+}
+
+bool Socket::enableKeepAlive(SOCKET socket, KeepAliveConfig const& config)
+{
+    int flag = 1;
+    int idle = static_cast<int>(config.ka_idle);
+    int intvl = static_cast<int>(config.ka_intvl);
+    int cnt = static_cast<int>(config.ka_cnt);
+
+    if (setsockopt(socket, SOL_SOCKET, SO_KEEPALIVE, &flag, sizeof(flag)) != 0) return false;
+    if (setsockopt(socket, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle)) != 0) return false;
+    if (setsockopt(socket, IPPROTO_TCP, TCP_KEEPINTVL, &intvl, sizeof(intvl)) != 0) return false;
+    if (setsockopt(socket, IPPROTO_TCP, TCP_KEEPCNT, &cnt, sizeof(cnt)) != 0) return false;
+
+    return true;
+}
+
+void Socket::close(SOCKET socket)
+{
+    shutdown(socket, SD_BOTH);
+    ::close(socket);
+}
+
+bool Socket::waitReady(SOCKET socket, bool write, int timeout_ms)
+{
+    pollfd fd{ socket, static_cast<short>(write ? POLLOUT : POLLIN), 0 };
+    return poll(&fd, 1, timeout_ms) > 0;
+}
+
+int Socket::lastError()
+{
+    return errno;
+}
+
+bool Socket::isWouldBlock(int error)
+{
+    return error == EWOULDBLOCK || error == EAGAIN;
+}
+
+std::string Socket::errorString(int error)
+{
+    return strerror(error);
+}
+
+#endif
@@ -0,0 +1,39 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+
+#ifdef _WIN32
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+using SOCKET = int;
+using SOCKADDR_IN = sockaddr_in;
+
+inline constexpr SOCKET INVALID_SOCKET = -1;
+inline constexpr int SOCKET_ERROR = -1;
+inline constexpr int SD_BOTH = SHUT_RDWR;
+#endif
+
+#include "../Core/KeepAliveConfig.hpp"
+
+// Thin wrapper over the platform socket API. Everything outside this file
+// works with SOCKET/SOCKADDR_IN and these helpers only.
+class Socket
+{
+public:
+	static bool startup();
+	static void cleanup();
+
+	static bool setNonBlocking(SOCKET socket, bool enabled);
+	static bool enableKeepAlive(SOCKET socket, KeepAliveConfig const& config);
+	static void close(SOCKET socket);
+	static bool waitReady(SOCKET socket, bool write, int timeout_ms);
+
+	static int lastError();
+	static bool isWouldBlock(int error);
+	static std::string errorString(int error);
+};
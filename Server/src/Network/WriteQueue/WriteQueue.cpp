@@ -0,0 +1,97 @@
+#include "WriteQueue.hpp"
+
+#include <SQLiteCpp/Savepoint.h>
+#include <print>
+
+WriteQueue::WriteQueue(DatabasePool& db) : m_db(db), m_thread(&WriteQueue::writerLoop, this) {
+
+}
+
+WriteQueue::~WriteQueue() {
+    {
+        std::lock_guard lock(m_mtx);
+        m_terminated = true;
+    }
+    m_condition.notify_all();
+
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void WriteQueue::submit(Mutation mutation) {
+    {
+        std::lock_guard lock(m_mtx);
+        m_queue.push_back(std::move(mutation));
+    }
+    m_condition.notify_one();
+}
+
+void WriteQueue::writerLoop() {
+    std::vector<Mutation> group;
+    group.reserve(max_group);
+
+    while (true) {
+        {
+            std::unique_lock lock(m_mtx);
+            m_condition.wait(lock, [this]() { return !m_queue.empty() || m_terminated; });
+            if (m_queue.empty()) return;
+
+            // Whatever queued up during the last commit goes out at once, a
+            // short group waits a little for company
+            if (m_queue.size() < max_group && !m_terminated) {
+                m_condition.wait_for(lock, max_delay, [this]() { return m_queue.size() >= max_group || m_terminated; });
+            }
+
+            const size_t count = std::min(m_queue.size(), max_group);
+            for (size_t i = 0; i < count; ++i) {
+                group.push_back(std::move(m_queue.front()));
+                m_queue.pop_front();
+            }
+        }
+
+        this->commitGroup(group);
+        group.clear();
+    }
+}
+
+void WriteQueue::commitGroup(std::vector<Mutation>& group) {
+    auto db = m_db.writer();
+
+    std::vector<WriteResult> results(group.size());
+    bool committed = false;
+
+    try {
+        SQLite::Transaction transaction(*db);
+
+        for (size_t i = 0; i < group.size(); ++i) {
+            SQLite::Savepoint savepoint(*db, "mutation");
+
+            try {
+                results[i] = group[i].apply(db);
+            }
+            catch (const std::exception& e) {
+                std::println(stderr, "Write error: {}", e.what());
+                results[i] = { ResponseID::InternalError, "Internal server error" };
+            }
+
+            if (!results[i]) savepoint.rollbackTo();
+            savepoint.release();
+        }
+
+        transaction.commit();
+        committed = true;
+    }
+    catch (const std::exception& e) {
+        std::println(stderr, "Group commit of {} writes failed: {}", group.size(), e.what());
+    }
+
+    for (size_t i = 0; i < group.size(); ++i) {
+        if (!committed) results[i] = { ResponseID::InternalError, "Internal server error" };
+
+        try {
+            group[i].done(db, results[i]);
+        }
+        catch (const std::exception& e) {
+            std::println(stderr, "Write completion error: {}", e.what());
+        }
+    }
+}
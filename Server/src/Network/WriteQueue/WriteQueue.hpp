@@ -0,0 +1,51 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../PacketManager/Packets/WriteResult.hpp"
+#include "../../Utils/DatabasePool/DatabasePool.hpp"
+
+// The one thread that writes. Handlers queue their mutations here instead of
+// committing each on its own, the thread takes what has piled up, up to
+// max_group of them and lingering at most max_delay for more, and runs them
+// in a single transaction, so the whole group shares one commit and sync.
+//
+// Each mutation runs under its own savepoint: a refused or failing one is
+// rolled back alone and the rest of the group still commits. Completions
+// run after the commit returned, that is when clients get their replies.
+class WriteQueue
+{
+public:
+	struct Mutation {
+		// Inside the group's transaction, a failed result undoes what it wrote
+		std::function<WriteResult(DatabasePool::Lease&)>				apply;
+		// After the commit with apply's result, InternalError if the group could not commit
+		std::function<void(DatabasePool::Lease&, WriteResult const&)>	done;
+	};
+
+	static constexpr size_t max_group = 64;
+	static constexpr std::chrono::milliseconds max_delay{ 2 };
+
+private:
+	DatabasePool&			m_db;
+	std::mutex				m_mtx;
+	std::condition_variable	m_condition;
+	std::deque<Mutation>	m_queue;
+	bool					m_terminated = false;
+	std::thread				m_thread;
+
+	void writerLoop();
+	void commitGroup(std::vector<Mutation>& group);
+
+public:
+	explicit WriteQueue(DatabasePool& db);
+	// Mutations still queued are committed before the thread exits
+	~WriteQueue();
+
+	void submit(Mutation mutation);
+};
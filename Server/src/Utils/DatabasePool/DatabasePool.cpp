@@ -0,0 +1,64 @@
+#include "DatabasePool.hpp"
+
+#include <stdexcept>
+
+// Time a connection waits on a lock held by another one before SQLITE_BUSY
+static constexpr int busy_timeout_ms = 5000;
+
+DatabasePool::DatabasePool(std::string const& path, unsigned int reader_count) {
+    if (reader_count == 0) reader_count = 1;
+
+    // The writer goes first: it creates the file and switches it to WAL,
+    // which is stored in the database and applies to every later connection
+    auto writer = std::make_unique<Connection>(path, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE | SQLite::OPEN_NOMUTEX);
+    writer->db.setBusyTimeout(busy_timeout_ms);
+    writer->db.exec("PRAGMA journal_mode = WAL;");
+    // A reply means the write survives a power cut, the WriteQueue pays that
+    // sync once per group rather than once per write
+    writer->db.exec("PRAGMA synchronous = FULL;");
+    writer->db.exec("PRAGMA foreign_keys = ON;");
+    writer->db.exec("PRAGMA temp_store = MEMORY;");
+    writers.idle.push_back(std::move(writer));
+
+    // Each connection is used by one thread at a time, SQLite's own mutex is not needed
+    for (unsigned int i = 0; i < reader_count; ++i) {
+        auto reader = std::make_unique<Connection>(path, SQLite::OPEN_READONLY | SQLite::OPEN_NOMUTEX);
+        reader->db.setBusyTimeout(busy_timeout_ms);
+        reader->db.exec("PRAGMA temp_store = MEMORY;");
+        reader->db.exec("PRAGMA mmap_size = 268435456;");
+        readers.idle.push_back(std::move(reader));
+    }
+}
+
+std::unique_ptr<DatabasePool::Connection> DatabasePool::take(Slot& slot) {
+    std::unique_lock lock(slot.mtx);
+    slot.condition.wait(lock, [&slot]() { return !slot.idle.empty(); });
+    auto connection = std::move(slot.idle.back());
+    slot.idle.pop_back();
+    return connection;
+}
+
+void DatabasePool::give(Slot& slot, std::unique_ptr<Connection> connection) {
+    {
+        std::lock_guard lock(slot.mtx);
+        slot.idle.push_back(std::move(connection));
+    }
+    slot.condition.notify_one();
+}
+
+DatabasePool::Lease DatabasePool::reader() {
+    return Lease(readers, take(readers));
+}
+
+DatabasePool::Lease DatabasePool::writer() {
+    return Lease(writers, take(writers));
+}
+
+void DatabasePool::bind(SQLite::Statement& query, int index, nlohmann::json const& value) {
+    if (value.is_null())                query.bind(index);
+    else if (value.is_boolean())        query.bind(index, value.get<bool>() ? 1 : 0);
+    else if (value.is_number_integer()) query.bind(index, value.get<int64_t>());
+    else if (value.is_number_float())   query.bind(index, value.get<double>());
+    else if (value.is_string())         query.bind(index, value.get_ref<std::string const&>());
+    else throw std::invalid_argument("Unsupported value type");
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <string_view>
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+#include "../Json.hpp"
+
+#include "StatementCache.hpp"
+
+// SQLite connections in WAL mode: one writer and a set of read-only
+// connections. Readers never block each other or the writer, writes are
+// serialized on the single writer connection. A connection is handed out
+// as a Lease and goes back to the pool when the lease is destroyed, so a
+// handler must not ask for a second lease while it holds one.
+class DatabasePool {
+    // The cache is declared last so its statements are finalized before the database closes
+    struct Connection {
+        SQLite::Database db;
+        StatementCache statements;
+
+        Connection(std::string const& path, int flags) : db(path, flags) { }
+    };
+
+    struct Slot {
+        std::mutex mtx;
+        std::condition_variable condition;
+        std::vector<std::unique_ptr<Connection>> idle;
+    };
+
+    Slot readers;
+    Slot writers;
+
+    static std::unique_ptr<Connection> take(Slot& slot);
+    static void give(Slot& slot, std::unique_ptr<Connection> connection);
+
+public:
+    class Lease {
+        Slot* slot = nullptr;
+        std::unique_ptr<Connection> connection;
+
+    public:
+        Lease(Slot& slot, std::unique_ptr<Connection> connection) : slot(&slot), connection(std::move(connection)) { }
+        Lease(Lease&& other) noexcept = default;
+        Lease& operator=(Lease&&) = delete;
+        ~Lease() {
+            if (!connection) return;
+            connection->statements.release();
+            give(*slot, std::move(connection));
+        }
+
+        // Cached prepared statement, valid until the lease ends
+        SQLite::Statement& prepare(std::string_view sql) { return connection->statements.prepare(connection->db, sql); }
+
+        SQLite::Database& operator*() const { return connection->db; }
+        SQLite::Database* operator->() const { return &connection->db; }
+        operator SQLite::Database&() const { return connection->db; }
+    };
+
+    DatabasePool(std::string const& path, unsigned int reader_count);
+
+    // Blocks until a connection is free
+    Lease reader();
+    Lease writer();
+
+    // Binds a scalar JSON value, throws std::invalid_argument for objects and arrays
+    static void bind(SQLite::Statement& query, int index, nlohmann::json const& value);
+};
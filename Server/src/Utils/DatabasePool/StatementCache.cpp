@@ -0,0 +1,40 @@
+#include "StatementCache.hpp"
+
+#include <algorithm>
+
+bool StatementCache::inUse(SQLite::Statement const* statement) const {
+    return std::find(in_use.begin(), in_use.end(), statement) != in_use.end();
+}
+
+SQLite::Statement& StatementCache::prepare(SQLite::Database& db, std::string_view sql) {
+    if (auto it = index.find(sql); it != index.end()) {
+        entries.splice(entries.begin(), entries, it->second);
+
+        auto& statement = *it->second->second;
+        statement.tryReset();
+        statement.clearBindings();
+        if (!inUse(&statement)) in_use.push_back(&statement);
+        return statement;
+    }
+
+    // Compile first, a statement that fails to prepare never enters the cache
+    std::string text(sql);
+    auto statement = std::make_unique<SQLite::Statement>(db, text);
+    entries.emplace_front(std::move(text), std::move(statement));
+    index.emplace(entries.front().first, entries.begin());
+    in_use.push_back(entries.front().second.get());
+
+    // A statement still in use by the current lease stays, the cache may run over for a while
+    if (entries.size() > capacity && !inUse(entries.back().second.get())) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+
+    return *entries.front().second;
+}
+
+void StatementCache::release() noexcept {
+    for (auto* statement : in_use)
+        statement->tryReset();
+    in_use.clear();
+}
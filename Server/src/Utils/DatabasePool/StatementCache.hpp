@@ -0,0 +1,31 @@
+#pragma once
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+// Prepared statements of one connection keyed by their SQL text. A cached
+// statement comes back reset with its bindings cleared, the least recently
+// used one is finalized once the cache is full. Everything handed out is
+// reset again on release, so a half stepped SELECT does not keep its WAL
+// snapshot open after the connection went back to the pool.
+class StatementCache {
+    using Entry = std::pair<std::string, std::unique_ptr<SQLite::Statement>>;
+
+    std::list<Entry> entries; // most recently used first
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+    std::vector<SQLite::Statement*> in_use;
+    size_t capacity;
+
+    bool inUse(SQLite::Statement const* statement) const;
+
+public:
+    explicit StatementCache(size_t capacity = 64) : capacity(capacity) { }
+
+    SQLite::Statement& prepare(SQLite::Database& db, std::string_view sql);
+    void release() noexcept;
+};
@@ -0,0 +1,43 @@
+#include "BoundedExecutor.hpp"
+
+BoundedExecutor::BoundedExecutor(unsigned int thread_count, size_t max_queued) : max_queued(max_queued) {
+    if (thread_count == 0) thread_count = 1;
+
+    for (unsigned int i = 0; i < thread_count; ++i)
+        threads.emplace_back(&BoundedExecutor::workerLoop, this);
+}
+
+BoundedExecutor::~BoundedExecutor() {
+    {
+        std::lock_guard lock(mtx);
+        terminated = true;
+    }
+    condition.notify_all();
+
+    for (auto& thread : threads)
+        if (thread.joinable()) thread.join();
+}
+
+bool BoundedExecutor::enqueue(Task&& job) {
+    {
+        std::lock_guard lock(mtx);
+        if (terminated || jobs.size() >= max_queued) return false;
+        jobs.push_back(std::move(job));
+    }
+    condition.notify_one();
+    return true;
+}
+
+void BoundedExecutor::workerLoop() {
+    while (true) {
+        Task job;
+        {
+            std::unique_lock lock(mtx);
+            condition.wait(lock, [this]() { return !jobs.empty() || terminated; });
+            if (terminated) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+
+#include "Task.hpp"
+
+// Small fixed set of threads for deliberately slow CPU work (password
+// hashing) that must not occupy the ThreadPool workers serving everything
+// else. The queue is bounded: tryPost refuses a job once max_queued jobs are
+// waiting, so a burst is rejected up front instead of piling up latency.
+class BoundedExecutor {
+    std::vector<std::thread> threads;
+    std::mutex mtx;
+    std::condition_variable condition;
+    std::deque<Task> jobs;
+    size_t max_queued;
+    bool terminated = false;
+
+    void workerLoop();
+    bool enqueue(Task&& job);
+
+public:
+    BoundedExecutor(unsigned int thread_count, size_t max_queued);
+    ~BoundedExecutor();
+
+    template<typename F>
+    bool tryPost(F&& job) {
+        return enqueue(Task(std::forward<F>(job)));
+    }
+};
@@ -0,0 +1,41 @@
+#include "ConcurrencyLimiter.hpp"
+
+void ConcurrencyLimiter::enqueue(Task&& job) {
+    {
+        std::lock_guard lock(queue_mtx);
+        jobs.push_back(std::move(job));
+        if (running == limit) return;
+        ++running;
+    }
+    pool.addJob(DrainJob(shared_from_this()));
+}
+
+void ConcurrencyLimiter::drain() {
+    for (size_t executed = 0; executed < max_batch; ++executed) {
+        Task job;
+        {
+            std::lock_guard lock(queue_mtx);
+            if (jobs.empty()) {
+                --running;
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+
+    // The slot stays taken, the next drain picks up where this one stopped
+    pool.addJob(DrainJob(shared_from_this()));
+}
+
+void ConcurrencyLimiter::abandon() {
+    // The slot is free again. What waited behind the dropped drain goes the
+    // way of the pool's own unstarted jobs, destroyed outside the lock
+    std::deque<Task> dropped;
+    {
+        std::lock_guard lock(queue_mtx);
+        --running;
+        std::swap(dropped, jobs);
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "ThreadPool.hpp"
+
+// Strand with room for more than one job. Jobs posted to one limiter start in
+// order, up to limit of them run at the same time and may finish in any
+// order. The rest wait in the limiter rather than in the pool, so one owner
+// never holds more than limit workers.
+class ConcurrencyLimiter : public std::enable_shared_from_this<ConcurrencyLimiter> {
+    // A busy slot hands its worker back to the pool after this many jobs
+    static constexpr size_t max_batch = 32;
+
+    ThreadPool& pool;
+    std::mutex queue_mtx;
+    std::deque<Task> jobs;
+    size_t limit;
+    size_t running = 0;
+
+    // The pool job that runs drain(). One the pool drops unstarted
+    // (ThreadPool::dropUnstartedJobs, a stopped pool) calls abandon() instead
+    struct DrainJob {
+        std::shared_ptr<ConcurrencyLimiter> self;
+
+        explicit DrainJob(std::shared_ptr<ConcurrencyLimiter> self) : self(std::move(self)) {}
+        DrainJob(DrainJob&&) noexcept = default;
+        void operator()() { std::exchange(self, nullptr)->drain(); }
+        ~DrainJob() { if (self) self->abandon(); }
+    };
+
+    void enqueue(Task&& job);
+    void drain();
+    void abandon();
+
+public:
+    ConcurrencyLimiter(ThreadPool& pool, size_t limit) : pool(pool), limit(limit ? limit : 1) {}
+
+    template<typename F>
+    void post(F&& job) {
+        enqueue(Task(std::forward<F>(job)));
+    }
+};
@@ -0,0 +1,41 @@
+#include "Strand.hpp"
+
+void Strand::enqueue(Task&& job) {
+    {
+        std::lock_guard lock(queue_mtx);
+        jobs.push_back(std::move(job));
+        if (running) return;
+        running = true;
+    }
+    pool.addJob(DrainJob(shared_from_this()));
+}
+
+void Strand::drain() {
+    for (size_t executed = 0; executed < max_batch; ++executed) {
+        Task job;
+        {
+            std::lock_guard lock(queue_mtx);
+            if (jobs.empty()) {
+                running = false;
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+
+    // Still marked running, the next drain picks up where this one stopped
+    pool.addJob(DrainJob(shared_from_this()));
+}
+
+void Strand::abandon() {
+    // The strand is free again. What waited behind the dropped drain goes the
+    // way of the pool's own unstarted jobs, destroyed outside the lock
+    std::deque<Task> dropped;
+    {
+        std::lock_guard lock(queue_mtx);
+        running = false;
+        std::swap(dropped, jobs);
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "ThreadPool.hpp"
+
+// Serial executor on top of ThreadPool. Jobs posted to one strand run in
+// order and never overlap, but no worker sits blocked waiting for its turn:
+// at most one drain job per strand is queued in the pool at a time.
+class Strand : public std::enable_shared_from_this<Strand> {
+    // A busy strand hands its worker back to the pool after this many jobs
+    static constexpr size_t max_batch = 32;
+
+    ThreadPool& pool;
+    std::mutex queue_mtx;
+    std::deque<Task> jobs;
+    bool running = false;
+
+    // The pool job that runs drain(). One the pool drops unstarted
+    // (ThreadPool::dropUnstartedJobs, a stopped pool) calls abandon() instead
+    struct DrainJob {
+        std::shared_ptr<Strand> self;
+
+        explicit DrainJob(std::shared_ptr<Strand> self) : self(std::move(self)) {}
+        DrainJob(DrainJob&&) noexcept = default;
+        void operator()() { std::exchange(self, nullptr)->drain(); }
+        ~DrainJob() { if (self) self->abandon(); }
+    };
+
+    void enqueue(Task&& job);
+    void drain();
+    void abandon();
+
+public:
+    explicit Strand(ThreadPool& pool) : pool(pool) {}
+
+    template<typename F>
+    void post(F&& job) {
+        enqueue(Task(std::forward<F>(job)));
+    }
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Move-only replacement for std::function<void()>. Callables up to
+// inline_size bytes live inside the task itself, bigger ones go to the heap.
+// Captured buffers are moved along with the task and never copied.
+class Task {
+    static constexpr size_t inline_size = 64;
+
+    struct VTable {
+        void (*invoke)(void* storage);
+        void (*move)(void* dst, void* src) noexcept;
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template<typename F>
+    static constexpr bool fits_inline =
+        sizeof(F) <= inline_size &&
+        alignof(F) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible_v<F>;
+
+    template<typename F>
+    struct InlineOps {
+        static void invoke(void* storage) { (*static_cast<F*>(storage))(); }
+        static void move(void* dst, void* src) noexcept {
+            ::new (dst) F(std::move(*static_cast<F*>(src)));
+            static_cast<F*>(src)->~F();
+        }
+        static void destroy(void* storage) noexcept { static_cast<F*>(storage)->~F(); }
+        static constexpr VTable table{ invoke, move, destroy };
+    };
+
+    template<typename F>
+    struct HeapOps {
+        static F*& ptr(void* storage) { return *static_cast<F**>(storage); }
+        static void invoke(void* storage) { (*ptr(storage))(); }
+        static void move(void* dst, void* src) noexcept { ::new (dst) F*(ptr(src)); }
+        static void destroy(void* storage) noexcept { delete ptr(storage); }
+        static constexpr VTable table{ invoke, move, destroy };
+    };
+
+    alignas(std::max_align_t) unsigned char storage[inline_size];
+    const VTable* vtable = nullptr;
+
+public:
+    Task() noexcept = default;
+
+    template<typename F, typename Fn = std::decay_t<F>>
+        requires (!std::is_same_v<Fn, Task> && std::is_invocable_v<Fn&>)
+    Task(F&& func) {
+        if constexpr (fits_inline<Fn>) {
+            ::new (storage) Fn(std::forward<F>(func));
+            vtable = &InlineOps<Fn>::table;
+        }
+        else {
+            ::new (storage) Fn*(new Fn(std::forward<F>(func)));
+            vtable = &HeapOps<Fn>::table;
+        }
+    }
+
+    Task(Task&& other) noexcept : vtable(other.vtable) {
+        if (vtable) vtable->move(storage, other.storage);
+        other.vtable = nullptr;
+    }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this == &other) return *this;
+        reset();
+        vtable = other.vtable;
+        if (vtable) vtable->move(storage, other.storage);
+        other.vtable = nullptr;
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { reset(); }
+
+    void reset() noexcept {
+        if (!vtable) return;
+        vtable->destroy(storage);
+        vtable = nullptr;
+    }
+
+    explicit operator bool() const noexcept { return vtable != nullptr; }
+    void operator()() { vtable->invoke(storage); }
+};
@@ -1,23 +1,131 @@
 #include "ThreadPool.hpp"
 
+// Lets addJob from inside a job land on the calling worker's own deque
+static thread_local ThreadPool* current_pool = nullptr;
+static thread_local size_t current_index = 0;
+
 void ThreadPool::setupThreadPool(unsigned int thread_count) {
+    if (thread_count == 0) thread_count = 1;
+
     thread_pool.clear();
+    queues.clear();
+    for (unsigned int i = 0; i < thread_count; ++i)
+        queues.push_back(std::make_unique<WorkerQueue>());
     for (unsigned int i = 0; i < thread_count; ++i)
-        thread_pool.emplace_back(&ThreadPool::workerLoop, this);
+        thread_pool.emplace_back(&ThreadPool::workerLoop, this, i);
+    timer_thread = std::thread(&ThreadPool::timerLoop, this);
+}
+
+void ThreadPool::push(Task&& job) {
+    size_t index = current_pool == this
+        ? current_index
+        : next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+
+    {
+        std::lock_guard lock(queues[index]->mtx);
+        queues[index]->jobs.push_back(std::move(job));
+    }
+    queued_jobs.fetch_add(1);
+
+    // Pairs with the sleeping_workers increment in workerLoop: either the
+    // sleeper sees the new job or we see the sleeper
+    if (sleeping_workers.load() != 0) {
+        { std::lock_guard lock(sleep_mtx); }
+        condition.notify_one();
+    }
 }
 
-void ThreadPool::workerLoop() {
-    std::function<void()> job;
+bool ThreadPool::popLocal(size_t index, Task& job) {
+    auto& queue = *queues[index];
+    std::lock_guard lock(queue.mtx);
+    if (queue.jobs.empty()) return false;
+    job = std::move(queue.jobs.front());
+    queue.jobs.pop_front();
+    return true;
+}
+
+bool ThreadPool::steal(size_t index, Task& job) {
+    for (size_t i = 1; i < queues.size(); ++i) {
+        auto& victim = *queues[(index + i) % queues.size()];
+        std::unique_lock lock(victim.mtx, std::try_to_lock);
+        if (!lock.owns_lock() || victim.jobs.empty()) continue;
+        job = std::move(victim.jobs.back());
+        victim.jobs.pop_back();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    current_pool = this;
+    current_index = index;
+
+    Task job;
     while (!pool_terminated) {
-        {
-            std::unique_lock lock(queue_mtx);
-            condition.wait(lock, [this]() { return !job_queue.empty() || pool_terminated; });
-            if (pool_terminated) return;
-            job = job_queue.front();
-            job_queue.pop();
+        if (popLocal(index, job) || steal(index, job)) {
+            queued_jobs.fetch_sub(1);
+            job();
+            job.reset();
+            continue;
+        }
+
+        std::unique_lock lock(sleep_mtx);
+        sleeping_workers.fetch_add(1);
+        condition.wait(lock, [this]() { return queued_jobs.load() != 0 || pool_terminated; });
+        sleeping_workers.fetch_sub(1);
+    }
+}
+
+void ThreadPool::timerLoop() {
+    std::vector<std::shared_ptr<TimerWheel::Timer>> due;
+    std::unique_lock lock(timer_mtx);
+
+    while (!pool_terminated) {
+        timer_wheel.advance(TimerWheel::Clock::now(), due);
+
+        if (!due.empty()) {
+            lock.unlock();
+            for (auto& timer : due) {
+                if (timer->running.exchange(true)) continue;
+                push(Task([timer] {
+                    if (!timer->cancelled) timer->job();
+                    timer->running = false;
+                }));
+            }
+            due.clear();
+            lock.lock();
+            continue;
         }
-        job();
+
+        // Sleeps until the next occupied slot, not tick by tick
+        if (timer_wheel.empty())
+            timer_condition.wait(lock);
+        else
+            timer_condition.wait_until(lock, timer_wheel.nextWakeup());
+    }
+}
+
+TimerWheel::TimerId ThreadPool::schedule(std::chrono::milliseconds delay, std::chrono::milliseconds period, Task&& job) {
+    TimerWheel::TimerId id;
+    {
+        std::lock_guard lock(timer_mtx);
+        id = timer_wheel.schedule(delay, period, std::move(job));
     }
+    timer_condition.notify_one();
+    return id;
+}
+
+bool ThreadPool::cancelTimer(TimerId id) {
+    std::lock_guard lock(timer_mtx);
+    return timer_wheel.cancel(id);
+}
+
+void ThreadPool::terminate() {
+    pool_terminated = true;
+    { std::lock_guard lock(sleep_mtx); }
+    condition.notify_all();
+    { std::lock_guard lock(timer_mtx); }
+    timer_condition.notify_all();
 }
 
 ThreadPool::ThreadPool(unsigned int thread_count) {
@@ -25,12 +133,15 @@ ThreadPool::ThreadPool(unsigned int thread_count) {
 }
 
 ThreadPool::~ThreadPool() {
-    pool_terminated = true;
+    terminate();
     join();
 }
 
 void ThreadPool::join() {
-    for (auto& thread : thread_pool) thread.join();
+    for (auto& thread : thread_pool)
+        if (thread.joinable()) thread.join();
+    if (timer_thread.joinable())
+        timer_thread.join();
 }
 
 unsigned int ThreadPool::getThreadCount() const {
@@ -38,21 +149,36 @@ unsigned int ThreadPool::getThreadCount() const {
 }
 
 void ThreadPool::dropUnstartedJobs() {
-    pool_terminated = true;
-    join();
-    pool_terminated = false;
-    std::queue<std::function<void()>> empty;
-    std::swap(job_queue, empty);
-    setupThreadPool(thread_pool.size());
+    {
+        std::lock_guard lock(timer_mtx);
+        timer_wheel.clear();
+    }
+
+    // Workers keep running, only what is still queued goes away. Dropped jobs
+    // are destroyed outside the queue lock, their captures may be the last owners
+    for (auto& queue : queues) {
+        std::deque<Task> dropped;
+        {
+            std::lock_guard lock(queue->mtx);
+            std::swap(dropped, queue->jobs);
+            queued_jobs.fetch_sub(dropped.size());
+        }
+    }
 }
 
 void ThreadPool::stop() {
-    pool_terminated = true;
+    terminate();
     join();
 }
 
 void ThreadPool::start(unsigned int thread_count) {
     if (!pool_terminated) return;
+    join();
     pool_terminated = false;
+    queued_jobs = 0;
+    {
+        std::lock_guard lock(timer_mtx);
+        timer_wheel.clear();
+    }
     setupThreadPool(thread_count);
-}
\ No newline at end of file
+}
@@ -1,34 +1,61 @@
 #pragma once
 #include <vector>
-#include <queue>
+#include <deque>
+#include <memory>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
-#include <functional>
+#include <chrono>
+#include <utility>
 
+#include "Task.hpp"
+#include "TimerWheel.hpp"
+
+// Every worker owns a deque. Jobs posted from a worker stay on its own deque,
+// jobs from other threads are spread round robin, and an idle worker steals
+// from the others before going to sleep.
+// Delayed and periodic jobs wait in a timer wheel driven by one extra thread
+// and are posted to the workers when they come due.
 class ThreadPool {
+    struct WorkerQueue {
+        std::mutex mtx;
+        std::deque<Task> jobs;
+    };
+
     std::vector<std::thread> thread_pool;
-    std::queue<std::function<void()>> job_queue;
-    std::mutex queue_mtx;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::atomic<size_t> queued_jobs = 0;
+    std::atomic<size_t> next_queue = 0;
+    std::atomic<unsigned int> sleeping_workers = 0;
+    std::mutex sleep_mtx;
     std::condition_variable condition;
     std::atomic<bool> pool_terminated = false;
 
+    std::thread timer_thread;
+    std::mutex timer_mtx;
+    std::condition_variable timer_condition;
+    TimerWheel timer_wheel;
+
     void setupThreadPool(unsigned int thread_count);
-    void workerLoop();
+    void workerLoop(size_t index);
+    void timerLoop();
+    void push(Task&& job);
+    bool popLocal(size_t index, Task& job);
+    bool steal(size_t index, Task& job);
+    void terminate();
+    TimerWheel::TimerId schedule(std::chrono::milliseconds delay, std::chrono::milliseconds period, Task&& job);
 
 public:
+    using TimerId = TimerWheel::TimerId;
+
     explicit ThreadPool(unsigned int thread_count = std::thread::hardware_concurrency());
     ~ThreadPool();
 
     template<typename F>
-    void addJob(F job) {
+    void addJob(F&& job) {
         if (pool_terminated) return;
-        {
-            std::unique_lock lock(queue_mtx);
-            job_queue.push(std::function<void()>(job));
-        }
-        condition.notify_one();
+        push(Task(std::forward<F>(job)));
     }
 
     template<typename F, typename... Arg>
@@ -36,9 +63,23 @@ public:
         addJob([job, args...] { job(args...); });
     }
 
+    // Runs job once after delay
+    template<typename F>
+    TimerId addTimer(std::chrono::milliseconds delay, F&& job) {
+        return schedule(delay, std::chrono::milliseconds::zero(), Task(std::forward<F>(job)));
+    }
+
+    // Runs job every interval, a run still in progress makes the next one skip
+    template<typename F>
+    TimerId addPeriodic(std::chrono::milliseconds interval, F&& job) {
+        return schedule(interval, interval, Task(std::forward<F>(job)));
+    }
+
+    bool cancelTimer(TimerId id);
+
     void join();
     unsigned int getThreadCount() const;
     void dropUnstartedJobs();
     void stop();
     void start(unsigned int thread_count = std::thread::hardware_concurrency());
-};
\ No newline at end of file
+};
@@ -0,0 +1,116 @@
+#include "TimerWheel.hpp"
+
+#include <algorithm>
+
+uint64_t TimerWheel::toTicks(Clock::duration duration) const {
+    if (duration <= Clock::duration::zero()) return 0;
+    return static_cast<uint64_t>((duration + tick - Clock::duration(1)) / tick);
+}
+
+TimerWheel::TimerId TimerWheel::schedule(Clock::duration delay, Clock::duration period, Task&& job) {
+    // Relative to the clock rather than current_tick, the owner may have slept through several ticks
+    uint64_t now_tick = static_cast<uint64_t>((Clock::now() - start_time) / tick);
+
+    auto id = next_id++;
+    auto timer = std::make_shared<Timer>();
+    timer->id = id;
+    timer->expires = std::max(now_tick + std::max<uint64_t>(toTicks(delay), 1), current_tick + 1);
+    timer->period = period > Clock::duration::zero() ? std::max<uint64_t>(toTicks(period), 1) : 0;
+    timer->job = std::move(job);
+
+    timers.emplace(timer->id, timer);
+    insert(std::move(timer));
+    return id;
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    auto it = timers.find(id);
+    if (it == timers.end()) return false;
+
+    // The slot entry is dropped lazily when its slot is next visited
+    it->second->cancelled = true;
+    timers.erase(it);
+    return true;
+}
+
+void TimerWheel::clear() {
+    for (auto& [id, timer] : timers)
+        timer->cancelled = true;
+    timers.clear();
+
+    for (auto& level : levels)
+        for (auto& slot : level)
+            slot.clear();
+}
+
+void TimerWheel::insert(std::shared_ptr<Timer> timer) {
+    constexpr uint64_t wheel_span = 1ull << (slot_bits * level_count);
+
+    uint64_t when = std::max(timer->expires, current_tick + 1);
+    uint64_t delta = when - current_tick;
+
+    // Further than the wheel reaches: park in the last slot, it's re-inserted on cascade
+    if (delta >= wheel_span) {
+        when = current_tick + wheel_span - 1;
+        delta = wheel_span - 1;
+    }
+
+    unsigned level = 0;
+    while (level + 1 < level_count && delta >= (1ull << (slot_bits * (level + 1))))
+        ++level;
+
+    levels[level][(when >> (slot_bits * level)) & (slot_count - 1)].push_back(std::move(timer));
+}
+
+void TimerWheel::cascade(unsigned level) {
+    Slot moved;
+    std::swap(moved, levels[level][(current_tick >> (slot_bits * level)) & (slot_count - 1)]);
+
+    for (auto& timer : moved)
+        if (!timer->cancelled) insert(std::move(timer));
+}
+
+void TimerWheel::advance(Clock::time_point now, std::vector<std::shared_ptr<Timer>>& due) {
+    uint64_t target = static_cast<uint64_t>((now - start_time) / tick);
+
+    while (current_tick < target) {
+        ++current_tick;
+
+        for (unsigned level = 1; level < level_count; ++level) {
+            if ((current_tick & ((1ull << (slot_bits * level)) - 1)) != 0) break;
+            cascade(level);
+        }
+
+        Slot expired;
+        std::swap(expired, levels[0][current_tick & (slot_count - 1)]);
+
+        for (auto& timer : expired) {
+            if (timer->cancelled) continue;
+            if (timer->expires > current_tick) {
+                insert(std::move(timer));
+                continue;
+            }
+
+            due.push_back(timer);
+            if (timer->period) {
+                timer->expires = current_tick + timer->period;
+                insert(std::move(timer));
+            }
+            else {
+                timers.erase(timer->id);
+            }
+        }
+    }
+}
+
+TimerWheel::Clock::time_point TimerWheel::nextWakeup() const {
+    if (timers.empty()) return Clock::time_point::max();
+
+    // First occupied level 0 slot, or the next wrap where a higher level cascades
+    uint64_t ticks = 1;
+    for (; ticks < slot_count; ++ticks) {
+        uint64_t index = (current_tick + ticks) & (slot_count - 1);
+        if (index == 0 || !levels[0][index].empty()) break;
+    }
+    return start_time + tick * (current_tick + ticks);
+}
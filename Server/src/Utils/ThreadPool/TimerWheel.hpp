@@ -0,0 +1,61 @@
+#pragma once
+#include <stdint.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Task.hpp"
+
+// Hierarchical timer wheel: 4 levels of 64 slots with a 10 ms tick. Level 0
+// holds timers due within 64 ticks, each higher level covers 64 times the
+// range of the previous one and is cascaded down as the lower level wraps.
+// Scheduling and cancelling are O(1). Not thread safe, ThreadPool guards it.
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = uint64_t;
+
+    static constexpr auto tick = std::chrono::milliseconds(10);
+
+    struct Timer {
+        TimerId id;
+        uint64_t expires;
+        uint64_t period;
+        std::atomic_bool cancelled = false;
+        std::atomic_bool running = false;
+        Task job;
+    };
+
+private:
+    static constexpr unsigned slot_bits = 6;
+    static constexpr unsigned slot_count = 1u << slot_bits;
+    static constexpr unsigned level_count = 4;
+
+    using Slot = std::vector<std::shared_ptr<Timer>>;
+
+    std::array<std::array<Slot, slot_count>, level_count> levels;
+    std::unordered_map<TimerId, std::shared_ptr<Timer>> timers;
+    Clock::time_point start_time = Clock::now();
+    uint64_t current_tick = 0;
+    TimerId next_id = 1;
+
+    void insert(std::shared_ptr<Timer> timer);
+    void cascade(unsigned level);
+    uint64_t toTicks(Clock::duration duration) const;
+
+public:
+    TimerId schedule(Clock::duration delay, Clock::duration period, Task&& job);
+    bool cancel(TimerId id);
+    void clear();
+
+    // Moves the wheel up to `now` and collects every timer that came due,
+    // periodic ones are put back for their next run
+    void advance(Clock::time_point now, std::vector<std::shared_ptr<Timer>>& due);
+
+    // Until when the caller may sleep before the next advance has work to do
+    Clock::time_point nextWakeup() const;
+    bool empty() const { return timers.empty(); }
+};
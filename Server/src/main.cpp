@@ -1,7 +1,7 @@
 #include "Network/Server/Server.hpp"
 #include <print>
 
-int main(int argc, const char* argv) {
+int main(int argc, char* argv[]) {
     Server server(8081, { 1, 1, 1 });
     try {
         //Start server